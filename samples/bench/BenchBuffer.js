@@ -0,0 +1,48 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Buffer read, write, encode and decode on small buffers, as the sensor and
+// BLE code paths use them.
+
+var bench = require('./bench.js');
+
+var buf = new Buffer(64);
+buf.fill(0x5a);
+var text = "The quick brown fox jumps over the lazy dog, 0123456789";
+
+bench.add('readUInt8', 64, function(i) {
+    buf.readUInt8(i);
+});
+
+bench.add('writeUInt8', 64, function(i) {
+    buf.writeUInt8(i, i);
+});
+
+bench.add('readUInt32BE', 16, function(i) {
+    buf.readUInt32BE(i * 4);
+});
+
+bench.add('writeUInt32LE', 16, function(i) {
+    buf.writeUInt32LE(i, i * 4);
+});
+
+bench.add('toString hex, 64 bytes', 20, function() {
+    buf.toString('hex');
+});
+
+bench.add('toString base64, 64 bytes', 20, function() {
+    buf.toString('base64');
+});
+
+bench.add('toString utf8, 64 bytes', 20, function() {
+    buf.toString('utf8');
+});
+
+bench.add('new Buffer(string)', 20, function() {
+    new Buffer(text);
+});
+
+bench.add('write(string)', 20, function() {
+    buf.write(text);
+});
+
+bench.run();
@@ -0,0 +1,28 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Buffer method calls with different numbers of live Buffers. The time per
+// readUInt8 should stay the same however many Buffers exist; lower the counts
+// if the device runs out of memory.
+
+var bench = require('./bench.js');
+
+var counts = [1, 100, 1000];
+var live = [];
+
+function addCount(count) {
+    bench.prepare(function() {
+        while (live.length < count) {
+            live.push(new Buffer(4));
+        }
+    });
+    bench.add('readUInt8, ' + count + ' live Buffers', 100, function() {
+        // read from the oldest one
+        live[0].readUInt8(0);
+    });
+}
+
+for (var c = 0; c < counts.length; c++) {
+    addCount(counts[c]);
+}
+
+bench.run();
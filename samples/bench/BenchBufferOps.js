@@ -0,0 +1,72 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// The bulk Buffer functions against the same work done a byte at a time in
+// JavaScript, on Buffers from 64 bytes to 16KB. Each sample covers about 16KB
+// whatever the Buffer size, so the cases take about the same time.
+
+var bench = require('./bench.js');
+
+var sizes = [64, 1024, 16384];
+var SAMPLES = 10;
+
+function addSize(size) {
+    var a = new Buffer(size);
+    var b = new Buffer(size);
+    var c = new Buffer(size);
+    a.fill(1);
+    a.writeUInt8(2, size - 1);
+    c.fill(1);
+    var batch = 16384 / size;
+
+    function add(name, fn) {
+        bench.add(name + ", " + size + " bytes", batch, fn, SAMPLES);
+    }
+
+    add('fill (js)', function() {
+        for (var i = 0; i < size; i++) {
+            b.writeUInt8(1, i);
+        }
+    });
+    add('fill (native)', function() {
+        b.fill(1);
+    });
+
+    add('copy (js)', function() {
+        for (var i = 0; i < size; i++) {
+            b.writeUInt8(a.readUInt8(i), i);
+        }
+    });
+    add('copy (native)', function() {
+        a.copy(b);
+    });
+
+    add('compare (js)', function() {
+        for (var i = 0; i < size; i++) {
+            if (a.readUInt8(i) !== c.readUInt8(i))
+                break;
+        }
+    });
+    add('compare (native)', function() {
+        a.compare(c);
+    });
+
+    add('indexOf (js)', function() {
+        for (var i = 0; i < size; i++) {
+            if (a.readUInt8(i) === 2)
+                break;
+        }
+    });
+    add('indexOf (native)', function() {
+        a.indexOf(2);
+    });
+
+    add('concat (native)', function() {
+        Buffer.concat([a, c]);
+    });
+}
+
+for (var s = 0; s < sizes.length; s++) {
+    addSize(sizes[s]);
+}
+
+bench.run();
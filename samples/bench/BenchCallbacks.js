@@ -0,0 +1,27 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Callback dispatch: each listener call emits the next event, so every
+// operation is one trip from a native signal through the main loop to JS.
+
+var bench = require('./bench.js');
+var EventEmitter = require('events');
+
+var emitter = new EventEmitter();
+var left = 0;
+var finished = null;
+
+emitter.on('hop', function() {
+    if (--left > 0) {
+        emitter.emit('hop');
+    } else {
+        finished();
+    }
+});
+
+bench.addAsync('callback dispatch', 20, function(count, done) {
+    left = count;
+    finished = done;
+    emitter.emit('hop');
+}, 20);
+
+bench.run();
@@ -0,0 +1,26 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Event emit with N listeners: the cost of emit() itself, before the
+// listeners run from the main loop.
+
+var bench = require('./bench.js');
+var EventEmitter = require('events');
+
+var counts = [1, 8, 32];
+
+function listener() {
+}
+
+for (var c = 0; c < counts.length; c++) {
+    var emitter = new EventEmitter();
+    for (var i = 0; i < counts[c]; i++) {
+        emitter.on('bench', listener);
+    }
+    bench.add('emit, ' + counts[c] + ' listeners', 50, (function(emitter) {
+        return function() {
+            emitter.emit('bench');
+        };
+    })(emitter));
+}
+
+bench.run();
@@ -0,0 +1,28 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Promise settle: native promises fulfilled right away, timed until their
+// then() callbacks have run. Needs the profile module (PROFILE=on).
+
+var bench = require('./bench.js');
+
+var profile = null;
+try {
+    profile = require('profile');
+} catch (e) {
+    print("BenchPromise: needs a PROFILE=on build, skipping");
+}
+
+if (profile) {
+    bench.addAsync('promise settle', 20, function(count, done) {
+        var settled = 0;
+        function then() {
+            if (++settled == count)
+                done();
+        }
+        for (var i = 0; i < count; i++) {
+            profile.promise().then(then);
+        }
+    }, 20);
+}
+
+bench.run();
@@ -0,0 +1,18 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// require() of modules that are already loaded: a built in module, found by
+// name, and a JS file, found by its resolved path.
+
+var bench = require('./bench.js');
+
+require('./bench.js');
+
+bench.add('require builtin', 50, function() {
+    require('events');
+});
+
+bench.add('require file', 50, function() {
+    require('./bench.js');
+});
+
+bench.run();
@@ -0,0 +1,29 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Timer churn: creating and cancelling timers, and firing a burst of them.
+
+var bench = require('./bench.js');
+
+function nothing() {
+}
+
+bench.add('setTimeout + clearTimeout', 100, function() {
+    clearTimeout(setTimeout(nothing, 1000));
+});
+
+bench.add('setInterval + clearInterval', 100, function() {
+    clearInterval(setInterval(nothing, 1000));
+});
+
+bench.addAsync('setTimeout 0 fire', 32, function(count, done) {
+    var fired = 0;
+    function tick() {
+        if (++fired == count)
+            done();
+    }
+    for (var i = 0; i < count; i++) {
+        setTimeout(tick, 0);
+    }
+}, 20);
+
+bench.run();
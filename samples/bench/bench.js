@@ -0,0 +1,143 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Harness for the benchmarks in this directory; scripts/jsbench runs them
+// and collects the results.
+//
+// Each case is timed over a number of samples, and each sample runs the case
+// batch times. Per operation latencies come from the samples, so batch should
+// be large enough for a sample to take well over the clock resolution. Every
+// case prints one line:
+//
+//     BENCH {"name":..., "ops_per_sec":..., "p50_us":..., "p99_us":...,
+//            "peak_heap":...}
+//
+// where peak_heap is the most ZJS heap in use during the case, or null when
+// the memory module isn't built in. "BENCH done" follows the last case.
+
+var profile = null, memory = null;
+try {
+    profile = require('profile');
+} catch (e) {
+    // fall back to Date.now(), which only has millisecond resolution
+}
+try {
+    memory = require('memory');
+} catch (e) {
+}
+
+var SAMPLES = 50;
+
+var cases = [];
+
+function now() {
+    return profile ? profile.now() : Date.now() * 1000;
+}
+
+function heapPeak() {
+    if (!memory)
+        return null;
+    return memory.peak();
+}
+
+function report(c, times) {
+    // times are the microseconds each sample took
+    var total = 0;
+    var perOp = [];
+    for (var i = 0; i < times.length; i++) {
+        total += times[i];
+        perOp.push(times[i] / c.batch);
+    }
+    perOp.sort(function(a, b) { return a - b; });
+
+    function percentile(p) {
+        var index = Math.ceil(p / 100 * perOp.length) - 1;
+        return perOp[Math.max(index, 0)];
+    }
+
+    var ops = c.batch * times.length;
+    print("BENCH " + JSON.stringify({
+        name: c.name,
+        ops_per_sec: total ? Math.round(ops * 1000000 / total) : null,
+        p50_us: percentile(50),
+        p99_us: percentile(99),
+        peak_heap: heapPeak()
+    }));
+}
+
+function runCase(index) {
+    if (index == cases.length) {
+        print("BENCH done");
+        return;
+    }
+
+    var c = cases[index];
+    var times = [];
+
+    function next() {
+        // let callbacks from the last case drain before starting the next
+        setTimeout(function() {
+            runCase(index + 1);
+        }, 0);
+    }
+
+    if (c.prepare) {
+        c.prepare();
+        next();
+        return;
+    }
+
+    if (memory)
+        memory.resetPeaks();
+
+    if (!c.async) {
+        for (var s = 0; s < c.samples; s++) {
+            var start = now();
+            for (var i = 0; i < c.batch; i++) {
+                c.fn(i);
+            }
+            times.push((now() - start) >>> 0);
+        }
+        report(c, times);
+        next();
+        return;
+    }
+
+    function sample() {
+        if (times.length == c.samples) {
+            report(c, times);
+            next();
+            return;
+        }
+        var start = now();
+        c.fn(c.batch, function() {
+            times.push((now() - start) >>> 0);
+            sample();
+        });
+    }
+    sample();
+}
+
+// requires: fn(i) does one operation, i counts up from 0 in each sample
+//  effects: adds a case timing fn synchronously
+exports.add = function(name, batch, fn, samples) {
+    cases.push({ name: name, batch: batch, fn: fn, async: false,
+                 samples: samples || SAMPLES });
+};
+
+// requires: fn(count, done) starts count operations and calls done once they
+//             have all completed
+//  effects: adds a case timing fn through the main loop
+exports.addAsync = function(name, batch, fn, samples) {
+    cases.push({ name: name, batch: batch, fn: fn, async: true,
+                 samples: samples || SAMPLES });
+};
+
+// effects: calls fn, untimed, between the cases added before and after it
+exports.prepare = function(fn) {
+    cases.push({ prepare: fn });
+};
+
+// effects: runs the cases added so far, in order
+exports.run = function() {
+    runCase(0);
+};
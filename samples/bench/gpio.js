@@ -0,0 +1,21 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// GPIO reads on Arduino 101. Each read looks up the pin and activeLow
+// properties on the pin object, so this shows the per-read cost of those
+// lookups on top of the driver call. Needs no wiring, IO4 is read floating.
+//
+// This only runs on the device, so unlike the Bench*.js files make bench
+// doesn't pick it up. It needs require() to find bench.js, so load both files
+// into ashell and run it from there.
+
+var bench = require('./bench.js');
+var gpio = require("gpio");
+var pins = require("arduino101_pins");
+
+var pin = gpio.open({ pin: pins.IO4, direction: 'in' });
+
+bench.add('GPIO read', 100, function() {
+    pin.read();
+});
+
+bench.run();
@@ -0,0 +1,66 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Startup benchmark: a script shaped like a typical application, with a few
+// modules and a fair amount of code to parse, for scripts/startupbench. Unlike
+// the Bench*.js files it doesn't use bench.js, since what it measures is over
+// before any of its own code runs. Build with PROFILE=on; once the startup
+// phases are done they're printed from JS too.
+var EventEmitter = require('events');
+
+var state = {
+    count: 0,
+    readings: new RingBuffer(16),
+    packet: new Buffer(8)
+};
+
+function Sensor(name, period) {
+    this.name = name;
+    this.period = period;
+    this.emitter = new EventEmitter();
+}
+
+Sensor.prototype.sample = function() {
+    var value = (state.count * 7 + this.period) % 100;
+    state.readings.push(value);
+    this.emitter.emit('reading', value);
+    return value;
+};
+
+Sensor.prototype.report = function() {
+    state.packet.pack('<HHf', [state.count, state.readings.count(),
+                               state.readings.average()], 0);
+    return state.packet.toString('hex');
+};
+
+function makeSensors(n) {
+    var list = [];
+    for (var i = 0; i < n; i++) {
+        var sensor = new Sensor('sensor' + i, 10 * (i + 1));
+        sensor.emitter.on('reading', function(value) {
+            state.count++;
+        });
+        list.push(sensor);
+    }
+    return list;
+}
+
+var sensors = makeSensors(4);
+for (var i = 0; i < sensors.length; i++) {
+    sensors[i].sample();
+}
+print("report: " + sensors[0].report());
+
+// the run phase ends with the top level of the script, so look afterwards
+setTimeout(function() {
+    var profile;
+    try {
+        profile = require('profile');
+    } catch (e) {
+        print("build with PROFILE=on to see the startup phases");
+        return;
+    }
+    var phases = profile.startup();
+    for (var name in phases) {
+        print(name + ": " + phases[name] + "us");
+    }
+}, 0);
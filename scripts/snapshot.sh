@@ -0,0 +1,50 @@
+#!/bin/bash
+
+#
+# This script compiles a JS file into a JerryScript snapshot and writes it out
+# as a C byte array that main() executes directly from ROM:
+#
+# const uint8_t script_snapshot[] = { ........ }
+#
+# The snapshot is made by a host build of the same JerryScript the target uses,
+# since the bytecode format changes between versions.
+#
+
+if [ $# -lt 2 ]; then
+    echo "Usage: ./snapshot.sh <script> <output.c> [output.snapshot]"
+    exit 1
+fi
+
+INPUT=$1
+OUTPUT=$2
+SNAPSHOT=${3:-/tmp/gen.snapshot}
+
+JERRY_BASE=${JERRY_BASE:-$ZJS_BASE/deps/jerryscript}
+JERRY=$JERRY_BASE/build/snapshot/bin/jerry
+
+if [ ! -x $JERRY ]; then
+    echo Building host JerryScript for snapshots...
+    (cd $JERRY_BASE; python ./tools/build.py --builddir=build/snapshot \
+        --jerry-cmdline=on --snapshot-save=on) > /dev/null
+    if [ $? -ne 0 ]; then
+        echo Error: Unable to build host JerryScript!
+        exit 1
+    fi
+fi
+
+$JERRY --save-snapshot-for-global $SNAPSHOT $INPUT
+ERR=$?
+if (($ERR > 0)); then
+    echo Error: Unable to create snapshot from $INPUT!
+    exit $ERR
+fi
+
+# jerry_exec_snapshot runs the bytecode in place, so it must stay aligned
+printf "/* This file was auto-generated */\n\n" > $OUTPUT
+printf "#include \"zjs_common.h\"\n\n" >> $OUTPUT
+printf "const uint8_t script_snapshot[] __attribute__((aligned(8))) = {\n" >> $OUTPUT
+od -An -v -tx1 $SNAPSHOT | sed -e 's/ *\([0-9a-f][0-9a-f]\)/ 0x\1,/g' >> $OUTPUT
+printf "};\n\n" >> $OUTPUT
+printf "const uint32_t script_snapshot_size = sizeof(script_snapshot);\n" >> $OUTPUT
+
+echo Snapshot is $(stat -c%s $SNAPSHOT 2> /dev/null || stat -f%z $SNAPSHOT) bytes
@@ -31,6 +31,10 @@
 
 #include "acm-uart.h"
 #include "file-wrapper.h"
+#include "../zjs_callbacks.h"
+#include "../zjs_modules.h"
+#include "../zjs_timers.h"
+#include "../zjs_util.h"
 
 static jerry_value_t parsed_code = 0;
 
@@ -60,11 +64,20 @@ void javascript_stop()
     jerry_release_value(parsed_code);
     parsed_code = 0;
 
+    /* Values held from C must be released before the engine goes away */
+    zjs_timers_cleanup();
+    zjs_callbacks_cleanup();
+    zjs_modules_cleanup();
+    zjs_release_prototypes();
+    zjs_release_prop_names();
+
     /* Cleanup engine */
     jerry_cleanup();
 
     /* Initialize engine */
     jerry_init(JERRY_INIT_EMPTY);
+    zjs_init_prop_names();
+    zjs_init_prototypes();
 }
 
 void javascript_run_code(const char *file_name)
@@ -111,5 +124,46 @@ void javascript_run_code(const char *file_name)
 
 void javascript_run_snapshot(const char *file_name)
 {
+    javascript_stop();
+
+    ZFILE *fp = csopen(file_name, "r");
+    if (fp == NULL)
+        return;
+
+    fs_seek(fp, 0, SEEK_END);
+    off_t len = fs_tell(fp);
+    if (len == 0) {
+        printf("Empty file\n");
+        fs_close(fp);
+        return;
+    }
+
+    /* malloc keeps the bytecode aligned as the engine requires */
+    uint8_t *buf = (uint8_t *)malloc(len);
+    if (!buf) {
+        printf("Not enough memory for snapshot\n");
+        fs_close(fp);
+        return;
+    }
+
+    fs_seek(fp, 0, SEEK_SET);
+    ssize_t brw = fs_read(fp, buf, len);
+    fs_close(fp);
+    if (brw != len) {
+        free(buf);
+        printf(" Failed loading snapshot from disk %s ", file_name);
+        return;
+    }
+
+    /* The engine copies the bytecode, so the file buffer can go right away */
+    jerry_value_t ret_value = jerry_exec_snapshot(buf, len, true);
+    free(buf);
+
+    if (jerry_value_has_error_flag(ret_value)) {
+        printf("JerryScript: could not run snapshot\n");
+    }
+    jerry_release_value(ret_value);
 
+    /* Mark the engine as in use so the next run starts from a clean one */
+    parsed_code = jerry_create_undefined();
 }
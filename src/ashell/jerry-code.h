@@ -18,6 +18,7 @@
 #define __jerry_code_runner_h__
 
 void javascript_run_code(const char *file_name);
+void javascript_run_snapshot(const char *file_name);
 void javascript_eval_code(const char *source_buffer);
 void javascript_stop();
 
@@ -36,6 +36,9 @@
 #include "file-wrapper.h"
 #include "ihex-handler.h"
 #include "jerry-code.h"
+#include "../zjs_gc.h"
+#include "../zjs_mem.h"
+#include "../zjs_trace.h"
 
 #ifdef CONFIG_REBOOT
 //TODO Waiting for patch https://gerrit.zephyrproject.org/r/#/c/3161/
@@ -307,7 +310,14 @@ int32_t ashell_run_javascript(char *buf)
     }
 
     printk("[RUN][%s]\r\n", filename);
-    javascript_run_code(filename);
+
+    /* Files made by scripts/snapshot.sh hold bytecode, not source */
+    const char *ext = ".snapshot";
+    size_t len = strlen(filename);
+    if (len > strlen(ext) && !strcmp(filename + len - strlen(ext), ext))
+        javascript_run_snapshot(filename);
+    else
+        javascript_run_code(filename);
     return RET_OK;
 }
 
@@ -521,6 +531,19 @@ int32_t ashell_stop_javascript(char *buf)
     return RET_OK;
 }
 
+int32_t ashell_stat(char *buf)
+{
+    zjs_mem_print_stats();
+    zjs_gc_print_stats();
+    return RET_OK;
+}
+
+int32_t ashell_trace(char *buf)
+{
+    zjs_trace_dump();
+    return RET_OK;
+}
+
 int32_t ashell_check_control(const char *buf, uint32_t len)
 {
     while (len > 0) {
@@ -547,6 +570,8 @@ static const struct shell_cmd commands[] =
     ASHELL_COMMAND("load",  "[FILE] Saves the input text into a file"        ,ashell_read_data),
     ASHELL_COMMAND("run",   "[FILE] Runs the JavaScript program in the file" ,ashell_run_javascript),
     ASHELL_COMMAND("stop",  "Stops current JavaScript execution"             ,ashell_stop_javascript),
+    ASHELL_COMMAND("stat",  "Memory usage per module (MEM_STATS=on build)"   ,ashell_stat),
+    ASHELL_COMMAND("trace", "Dump allocation trace snapshot (TRACE=on build)",ashell_trace),
 
     ASHELL_COMMAND("ls",    "[FILE] List directory contents or file stat"    ,ashell_list_dir),
     ASHELL_COMMAND("cat",   "[FILE] Print the file contents on the stdout"   ,ashell_print_file),
@@ -4,6 +4,7 @@
 #include <zephyr.h>
 #include "zjs_zephyr_time.h"
 #else
+#include <signal.h>
 #include "zjs_linux_time.h"
 #endif // ZJS_LINUX_BUILD
 #include <string.h>
@@ -21,13 +22,23 @@
 #include "zjs_callbacks.h"
 #include "zjs_common.h"
 #include "zjs_event.h"
+#include "zjs_gc.h"
+#include "zjs_mem.h"
 #include "zjs_modules.h"
+#include "zjs_profile.h"
+#include "zjs_ringbuffer.h"
 #include "zjs_timers.h"
+#include "zjs_trace.h"
 #include "zjs_util.h"
 
 #include "zjs_ble.h"
 
+#ifdef ZJS_SNAPSHOT_BUILD
+extern const uint8_t script_snapshot[];
+extern const uint32_t script_snapshot_size;
+#else
 extern const char *script_gen;
+#endif
 
 // native eval handler
 static jerry_value_t native_eval_handler(const jerry_value_t function_obj,
@@ -38,16 +49,100 @@ static jerry_value_t native_eval_handler(const jerry_value_t function_obj,
     return zjs_error("native_eval_handler: eval not supported");
 }
 
+#if defined(ZJS_LINUX_BUILD) || defined(ZJS_SNAPSHOT_BUILD)
+static jerry_value_t run_snapshot(const void *snapshot, size_t size, bool copy)
+{
+    // effects: runs the bytecode in snapshot, copying it to the heap first if
+    //            copy is true, and returns the result, which has the error
+    //            flag set if it failed
+    jerry_value_t result = jerry_exec_snapshot(snapshot, size, copy);
+    zjs_profile_mark("run");
+    if (jerry_value_has_error_flag(result)) {
+        PRINT("JerryScript: cannot run snapshot\n");
+    }
+    return result;
+}
+#endif
+
+#if defined(ZJS_LINUX_BUILD) || !defined(ZJS_SNAPSHOT_BUILD)
+static jerry_value_t run_source(const char *script, uint32_t len)
+{
+    // effects: parses and runs the JS source in script, and returns the
+    //            result, which has the error flag set if either step failed
+    jerry_value_t code_eval = jerry_parse((jerry_char_t *)script, len, false);
+    zjs_profile_mark("parse");
+    if (jerry_value_has_error_flag(code_eval)) {
+        PRINT("JerryScript: cannot parse javascript\n");
+        return code_eval;
+    }
+    jerry_value_t result = jerry_run(code_eval);
+    zjs_profile_mark("run");
+    jerry_release_value(code_eval);
+    if (jerry_value_has_error_flag(result)) {
+        PRINT("JerryScript: cannot run javascript\n");
+    }
+    return result;
+}
+#endif
+
+#ifdef ZJS_LINUX_BUILD
+// set by the first SIGINT or SIGTERM to leave the main loop; a second one
+//   kills jslinux as before, in case the script itself is stuck
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int sig)
+{
+    stop_requested = 1;
+}
+
+static bool is_snapshot(const char *name)
+{
+    // effects: returns true if name is a file made by scripts/snapshot.sh
+    const char *ext = ".snapshot";
+    size_t len = strlen(name);
+    return len > strlen(ext) && !strcmp(name + len - strlen(ext), ext);
+}
+#endif
+
 #ifndef ZJS_LINUX_BUILD
 void main(void)
 #else
 int main(int argc, char *argv[])
 #endif
 {
+#if defined(ZJS_LINUX_BUILD) || !defined(ZJS_SNAPSHOT_BUILD)
     const char *script = NULL;
-    jerry_value_t code_eval;
-    jerry_value_t result;
     uint32_t len;
+#endif
+    jerry_value_t result;
+    jerry_init_flag_t jerry_flags = JERRY_INIT_EMPTY;
+
+    zjs_profile_start();
+
+#ifdef ZJS_LINUX_BUILD
+    // options come before the script name
+    bool forever = false;
+    bool mem_report = false;
+    int arg = 1;
+    for (; arg < argc && !strncmp(argv[arg], "--", 2); arg++) {
+        if (!strcmp(argv[arg], "--forever")) {
+            // keep running once nothing is pending, as jslinux used to
+            forever = true;
+        } else if (!strcmp(argv[arg], "--mem-report")) {
+            // print memory use when jslinux stops, for scripts/memfootprint
+            mem_report = true;
+            jerry_flags = JERRY_INIT_MEM_STATS;
+        } else {
+            PRINT("usage: jslinux [--forever] [--mem-report] [script]\n");
+            return 1;
+        }
+    }
+
+    struct sigaction stop = { .sa_handler = request_stop,
+                              .sa_flags = SA_RESETHAND };
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+#endif
 
     // print newline here to make it easier to find
     // the beginning of the program
@@ -58,9 +153,15 @@ int main(int argc, char *argv[])
 #ifdef DUMP_MEM_STATS
     zjs_print_pools();
 #endif
+    zjs_profile_mark("pools");
 #endif
+    zjs_trace_init();
 
-    jerry_init(JERRY_INIT_EMPTY);
+    jerry_init(jerry_flags);
+    zjs_profile_mark("jerry_init");
+    zjs_init_prop_names();
+    zjs_init_prototypes();
+    zjs_gc_init();
 
     zjs_timers_init();
 #ifndef ZJS_LINUX_BUILD
@@ -68,54 +169,59 @@ int main(int argc, char *argv[])
 #endif
 #ifdef BUILD_MODULE_BUFFER
     zjs_buffer_init();
+    zjs_ringbuffer_init();
 #endif
-    zjs_init_callbacks();
 
     // initialize modules
     zjs_modules_init();
 
+    jerry_value_t global_obj = jerry_get_global_object();
+
+    // Todo: find a better solution to disable eval() in JerryScript.
+    // For now, just inject our eval() function in the global space
+    zjs_obj_add_function(global_obj, native_eval_handler, "eval");
+    jerry_release_value(global_obj);
+    zjs_profile_mark("modules");
+
 #ifdef ZJS_LINUX_BUILD
-    if (argc > 1) {
-        zjs_read_script(argv[1], &script, &len);
+    if (arg < argc) {
+        zjs_read_script(argv[arg], &script, &len);
+        if (!script) {
+            goto error;
+        }
+        zjs_profile_mark("load");
+        zjs_modules_set_path(argv[arg]);
+        if (is_snapshot(argv[arg])) {
+            // the file is freed below, so the engine must copy the bytecode
+            result = run_snapshot(script, len, true);
+        } else {
+            result = run_source(script, len);
+        }
+        zjs_free_script(script, len);
     } else
     // slightly tricky: reuse next section as else clause
 #endif
     {
+#ifdef ZJS_SNAPSHOT_BUILD
+        // the bytecode runs in place from ROM, with no parsing and no copy
+        result = run_snapshot(script_snapshot, script_snapshot_size, false);
+#else
         script = script_gen;
         len = strnlen(script_gen, MAX_SCRIPT_SIZE);
         if (len == MAX_SCRIPT_SIZE) {
             PRINT("Error: Script size too large! Increase MAX_SCRIPT_SIZE.\n");
             goto error;
         }
-    }
-
-    jerry_value_t global_obj = jerry_get_global_object();
-
-    // Todo: find a better solution to disable eval() in JerryScript.
-    // For now, just inject our eval() function in the global space
-    zjs_obj_add_function(global_obj, native_eval_handler, "eval");
-
-    code_eval = jerry_parse((jerry_char_t *)script, len, false);
-    if (jerry_value_has_error_flag(code_eval)) {
-        PRINT("JerryScript: cannot parse javascript\n");
-        goto error;
-    }
-
-#ifdef ZJS_LINUX_BUILD
-    if (argc > 1) {
-        zjs_free_script(script);
-    }
+        zjs_profile_mark("load");
+        result = run_source(script, len);
 #endif
+    }
 
-    result = jerry_run(code_eval);
     if (jerry_value_has_error_flag(result)) {
-        PRINT("JerryScript: cannot run javascript\n");
         goto error;
     }
-
-    jerry_release_value(global_obj);
-    jerry_release_value(code_eval);
     jerry_release_value(result);
+    zjs_profile_print();
 
 #ifndef ZJS_LINUX_BUILD
 #ifndef QEMU_BUILD
@@ -125,17 +231,54 @@ int main(int argc, char *argv[])
 #endif
 #endif // ZJS_LINUX_BUILD
 
+#ifdef ZJS_LINUX_BUILD
+    while (!stop_requested) {
+#else
     while (1) {
+#endif
+        bool busy = false;
         zjs_timers_process_events();
 #ifndef ZJS_LINUX_BUILD
-        zjs_run_pending_callbacks();
+        busy = zjs_run_pending_callbacks();
 #endif
-        zjs_service_callbacks();
+        busy |= zjs_service_callbacks();
+        if (busy) {
+            zjs_gc_activity();
+        } else if (!zjs_callbacks_pending()) {
+            uint32_t next_ms = zjs_timers_next_ms();
+#ifdef ZJS_LINUX_BUILD
+            if (next_ms == UINT32_MAX && !forever) {
+                // no timers or callbacks left to run any more JS, so exit
+                //   the way node does
+                break;
+            }
+#endif
+            // nothing to do until the next timer, a good time to collect
+            zjs_gc_idle(next_ms);
+        }
+        zjs_trace_service();
         // not sure if this is okay, but it seems better to sleep than
         //   busy wait
         zjs_sleep(1);
     }
 
+#ifdef ZJS_LINUX_BUILD
+    if (mem_report) {
+        // the native numbers first, since cleanup frees what is still live;
+        //   JerryScript prints its heap stats from jerry_cleanup
+        zjs_mem_print_report();
+        fflush(stdout);
+    }
+    // let go of the values held natively so the engine can free them
+    zjs_timers_cleanup();
+    zjs_callbacks_cleanup();
+    zjs_modules_cleanup();
+    zjs_release_prototypes();
+    zjs_release_prop_names();
+    jerry_cleanup();
+    return zjs_callbacks_uncaught() ? 1 : 0;
+#endif
+
 error:
 #ifdef ZJS_LINUX_BUILD
     return 1;
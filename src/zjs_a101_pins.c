@@ -5,111 +5,104 @@
 
 // ZJS includes
 #include <zjs_gpio.h>
+#include <zjs_pins.h>
 #include <zjs_pwm.h>
 #include <zjs_util.h>
 
 #ifdef BUILD_MODULE_GPIO
-static void zjs_a101_num_to_gpio(uint32_t num, int *dev, int *pin)
-{
-    *dev = 0;
-    // pass through GPIO pin ranges (IO and LED pins, see zjs_aio_init)
-    if ((num >= 8 && num <= 12) || (num >= 15 && num <= 20) || num == 26) {
-        *pin = num;
-        return;
-    }
-    // not supported, at least currently
-    *pin = -1;
-}
+// pass through GPIO pin ranges (IO and LED pins, see zjs_aio_init); others
+//   are not supported, at least currently
+static const uint8_t a101_gpio_map[] = {
+    [8]  = ZJS_PIN(0, 8),
+    [9]  = ZJS_PIN(0, 9),
+    [10] = ZJS_PIN(0, 10),
+    [11] = ZJS_PIN(0, 11),
+    [12] = ZJS_PIN(0, 12),
+    [15] = ZJS_PIN(0, 15),
+    [16] = ZJS_PIN(0, 16),
+    [17] = ZJS_PIN(0, 17),
+    [18] = ZJS_PIN(0, 18),
+    [19] = ZJS_PIN(0, 19),
+    [20] = ZJS_PIN(0, 20),
+    [26] = ZJS_PIN(0, 26),
+};
+
+static const zjs_pin_map_t a101_gpio_pins = ZJS_PIN_MAP(a101_gpio_map);
 #endif
 
 #ifdef BUILD_MODULE_PWM
-static void zjs_a101_num_to_pwm(uint32_t num, int *dev, int *pin)
-{
-    *dev = 0;
-    if (num < 0) {
-        *pin = -1;
-        return;
-    }
-    if (num < 4) {
-        // support directly giving channel number 0-3
-        *pin = num;
-        return;
-    }
-    if (num >= 0x20 && num <= 0x23) {
-        // support PWM0 through PWM3
-        *pin = num - 0x20;
-        return;
-    }
+static const uint8_t a101_pwm_map[] = {
+    // support directly giving channel number 0-3
+    [0]    = ZJS_PIN(0, 0),
+    [1]    = ZJS_PIN(0, 1),
+    [2]    = ZJS_PIN(0, 2),
+    [3]    = ZJS_PIN(0, 3),
 
-    switch (num) {
-    case 17:  // IO3
-        *pin = 0;
-        break;
-    case 15:  // IO5
-        *pin = 1;
-        break;
-    case 12:  // IO6
-        *pin = 2;
-        break;
-    case 13:  // IO9
-        *pin = 3;
-        break;
+    [17]   = ZJS_PIN(0, 0),  // IO3
+    [15]   = ZJS_PIN(0, 1),  // IO5
+    [12]   = ZJS_PIN(0, 2),  // IO6
+    [13]   = ZJS_PIN(0, 3),  // IO9
 
-    default:
-        *pin = -1;
-    }
-}
-#endif
+    // support PWM0 through PWM3
+    [0x20] = ZJS_PIN(0, 0),
+    [0x21] = ZJS_PIN(0, 1),
+    [0x22] = ZJS_PIN(0, 2),
+    [0x23] = ZJS_PIN(0, 3),
+};
 
-jerry_value_t zjs_a101_init()
-{
-    // effects: returns an object with Arduino 101 pin mappings
-#ifdef BUILD_MODULE_GPIO
-    zjs_gpio_convert_pin = zjs_a101_num_to_gpio;
+static const zjs_pin_map_t a101_pwm_pins = ZJS_PIN_MAP(a101_pwm_map);
 #endif
-#ifdef BUILD_MODULE_PWM
-    zjs_pwm_convert_pin = zjs_a101_num_to_pwm;
-#endif
-
-    jerry_value_t obj = jerry_create_object();
 
+static const zjs_pin_name_t a101_pin_names[] = {
     // These are all the GPIOs that can be accessed as GPIOs by the X86 side.
-    zjs_obj_add_number(obj, 18, "IO2");
-    zjs_obj_add_number(obj, 17, "IO3");  // doesn't seem to work as output
-    zjs_obj_add_number(obj, 19, "IO4");
-    zjs_obj_add_number(obj, 15, "IO5");  // doesn't seem to work as output
-    zjs_obj_add_number(obj, 20, "IO7");
-    zjs_obj_add_number(obj, 16, "IO8");
-    zjs_obj_add_number(obj, 11, "IO10");
-    zjs_obj_add_number(obj, 10, "IO11");
-    zjs_obj_add_number(obj, 9,  "IO12");
-    zjs_obj_add_number(obj, 8,  "IO13");  // output also displayed on LED0
+    { "IO2", 18 },
+    { "IO3", 17 },  // doesn't seem to work as output
+    { "IO4", 19 },
+    { "IO5", 15 },  // doesn't seem to work as output
+    { "IO7", 20 },
+    { "IO8", 16 },
+    { "IO10", 11 },
+    { "IO11", 10 },
+    { "IO12", 9 },
+    { "IO13", 8 },  // output also displayed on LED0
 
     // These are onboard LEDs
-    zjs_obj_add_number(obj, 8,  "LED0");
-    zjs_obj_add_number(obj, 12, "LED1");  // active low
-    zjs_obj_add_number(obj, 26, "LED2");  // active low, red fault LED
+    { "LED0", 8 },
+    { "LED1", 12 },  // active low
+    { "LED2", 26 },  // active low, red fault LED
 
     // These cannot currently be used as GPIOs because they are controlled by
     // the ARC side and we don't have support for that. But they can be used as
     // PWMs.
-    zjs_obj_add_number(obj, 12, "IO6");
-    zjs_obj_add_number(obj, 13, "IO9");
+    { "IO6", 12 },
+    { "IO9", 13 },
 
-    zjs_obj_add_number(obj, 0x20,  "PWM0");
-    zjs_obj_add_number(obj, 0x21,  "PWM1");
-    zjs_obj_add_number(obj, 0x22,  "PWM2");
-    zjs_obj_add_number(obj, 0x23,  "PWM3");
+    { "PWM0", 0x20 },
+    { "PWM1", 0x21 },
+    { "PWM2", 0x22 },
+    { "PWM3", 0x23 },
 
     // TODO: It appears that some other GPIO pins can be used as analog inputs
     //   too, from the X86 side. We haven't tried that.
-    zjs_obj_add_number(obj, 10, "A0");
-    zjs_obj_add_number(obj, 11, "A1");
-    zjs_obj_add_number(obj, 12, "A2");
-    zjs_obj_add_number(obj, 13, "A3");
-    zjs_obj_add_number(obj, 14, "A4");
-    zjs_obj_add_number(obj, 9,  "A5");
+    { "A0", 10 },
+    { "A1", 11 },
+    { "A2", 12 },
+    { "A3", 13 },
+    { "A4", 14 },
+    { "A5", 9 },
+};
+
+jerry_value_t zjs_a101_init()
+{
+    // effects: returns an object with Arduino 101 pin mappings
+#ifdef BUILD_MODULE_GPIO
+    zjs_gpio_pins = &a101_gpio_pins;
+#endif
+#ifdef BUILD_MODULE_PWM
+    zjs_pwm_pins = &a101_pwm_pins;
+#endif
 
-    return obj;
+    return zjs_pins_create(a101_pin_names,
+                           sizeof(a101_pin_names) / sizeof(a101_pin_names[0]));
 }
 #endif // BUILD_MODULE_A101
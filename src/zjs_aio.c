@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_AIO
 #ifdef BUILD_MODULE_AIO
 #ifndef QEMU_BUILD
 // Zephyr includes
@@ -24,6 +25,28 @@ typedef struct aio_handle {
     jerry_value_t jvalue;
 } aio_handle_t;
 
+// Native handle of an AIOPin object, so methods don't have to look up the pin
+//   properties again
+typedef struct aio_pin {
+    uint32_t device;
+    uint32_t pin;
+    aio_handle_t *change;           // subscription for the change event
+} aio_pin_t;
+
+// the analog inputs the ARC side reads, ARC_AIO_MIN through ARC_AIO_MAX
+static const uint8_t arc_aio_map[] = {
+    [ARC_AIO_MIN + 0] = ZJS_PIN(0, ARC_AIO_MIN + 0),
+    [ARC_AIO_MIN + 1] = ZJS_PIN(0, ARC_AIO_MIN + 1),
+    [ARC_AIO_MIN + 2] = ZJS_PIN(0, ARC_AIO_MIN + 2),
+    [ARC_AIO_MIN + 3] = ZJS_PIN(0, ARC_AIO_MIN + 3),
+    [ARC_AIO_MIN + 4] = ZJS_PIN(0, ARC_AIO_MIN + 4),
+    [ARC_AIO_MAX]     = ZJS_PIN(0, ARC_AIO_MAX),
+};
+
+static const zjs_pin_map_t arc_aio_pins = ZJS_PIN_MAP(arc_aio_map);
+
+const zjs_pin_map_t *zjs_aio_pins = &arc_aio_pins;
+
 static aio_handle_t *zjs_aio_alloc_handle()
 {
     size_t size = sizeof(aio_handle_t);
@@ -187,24 +210,49 @@ static void ipm_msg_receive_callback(void *context, uint32_t id,
     }
 }
 
+static void zjs_aio_unsubscribe(aio_pin_t *pin)
+{
+    // effects: removes the pin's change handler, if any, and unsubscribes
+    if (pin->change) {
+        zjs_aio_ipm_send_async(TYPE_AIO_PIN_UNSUBSCRIBE, pin->pin,
+                               pin->change);
+        zjs_remove_callback(pin->change->callback_id);
+        zjs_aio_free_handle(pin->change);
+        pin->change = NULL;
+    }
+}
+
+static void zjs_aio_free_pin(const uintptr_t native)
+{
+    // effects: called when the pin object is garbage collected
+    aio_pin_t *pin = (aio_pin_t *)native;
+    zjs_aio_unsubscribe(pin);
+    zjs_free(pin);
+}
+
+static aio_pin_t *zjs_aio_get_pin(const jerry_value_t obj)
+{
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_AIO_PIN) ||
+        !jerry_get_object_native_handle(obj, &native)) {
+        return NULL;
+    }
+    return (aio_pin_t *)native;
+}
+
 static jerry_value_t zjs_aio_pin_read(const jerry_value_t function_obj,
                                       const jerry_value_t this,
                                       const jerry_value_t argv[],
                                       const jerry_length_t argc)
 {
-    uint32_t device, pin;
-    zjs_obj_get_uint32(this, "device", &device);
-    zjs_obj_get_uint32(this, "pin", &pin);
-
-    if (pin < ARC_AIO_MIN || pin > ARC_AIO_MAX) {
-        DBG_PRINT("PIN: #%lu\n", pin);
-        return zjs_error("zjs_aio_pin_read: pin out of range");
-    }
+    aio_pin_t *pin = zjs_aio_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_aio_pin_read: not an AIO pin");
 
     // send IPM message to the ARC side
     zjs_ipm_message_t* send = zjs_aio_alloc_msg();
     send->type = TYPE_AIO_PIN_READ;
-    send->data.aio.pin = pin;
+    send->data.aio.pin = pin->pin;
 
     jerry_value_t result = zjs_aio_call_remote_function(send);
     return result;
@@ -215,16 +263,10 @@ static jerry_value_t zjs_aio_pin_close(const jerry_value_t function_obj,
                                        const jerry_value_t argv[],
                                        const jerry_length_t argc)
 {
-    uint32_t pin;
-    zjs_obj_get_uint32(this, "pin", &pin);
-
-    aio_handle_t* handle;
-    if (jerry_get_object_native_handle(this, (uintptr_t*)&handle) && handle) {
+    aio_pin_t *pin = zjs_aio_get_pin(this);
+    if (pin) {
         // remove existing onchange handler and unsubscribe
-        zjs_aio_ipm_send_async(TYPE_AIO_PIN_UNSUBSCRIBE, pin, handle);
-        zjs_remove_callback(handle->callback_id);
-        jerry_set_object_native_handle(this, 0, NULL);
-        zjs_aio_free_handle(handle);
+        zjs_aio_unsubscribe(pin);
     }
 
     return ZJS_UNDEFINED;
@@ -242,8 +284,9 @@ static jerry_value_t zjs_aio_pin_on(const jerry_value_t function_obj,
         return zjs_error("zjs_aio_pin_on: invalid argument");
     }
 
-    uint32_t pin;
-    zjs_obj_get_uint32(this, "pin", &pin);
+    aio_pin_t *pin = zjs_aio_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_aio_pin_on: not an AIO pin");
 
     char event[MAX_TYPE_LEN];
     jerry_value_t arg = argv[0];
@@ -256,29 +299,25 @@ static jerry_value_t zjs_aio_pin_on(const jerry_value_t function_obj,
     if (strcmp(event, "change"))
         return zjs_error("zjs_aio_pin_on: unsupported event type");
 
-    aio_handle_t* handle;
-    if (jerry_get_object_native_handle(this, (uintptr_t*)&handle) && handle) {
+    if (pin->change) {
         if (jerry_value_is_null(argv[1])) {
             // no change function, remove if one existed before
-            zjs_aio_ipm_send_async(TYPE_AIO_PIN_UNSUBSCRIBE, pin, handle);
-            zjs_remove_callback(handle->callback_id);
-            jerry_set_object_native_handle(this, 0, NULL);
-            zjs_aio_free_handle(handle);
+            zjs_aio_unsubscribe(pin);
         } else {
             // switch to new change function
-            zjs_edit_js_func(handle->callback_id, argv[1]);
+            zjs_edit_js_func(pin->change->callback_id, argv[1]);
         }
     } else if (!jerry_value_is_null(argv[1])) {
         // new change function
-        handle = zjs_aio_alloc_handle();
+        aio_handle_t *handle = zjs_aio_alloc_handle();
         if (!handle)
             return zjs_error("zjs_aio_pin_on: could not allocate handle");
 
         handle->pin_obj = this;
-        jerry_set_object_native_handle(this, (uintptr_t)handle, NULL);
         handle->callback_id = zjs_add_callback(argv[1], this, handle,
                                                zjs_aio_pre_callback, NULL);
-        zjs_aio_ipm_send_async(TYPE_AIO_PIN_SUBSCRIBE, pin, handle);
+        pin->change = handle;
+        zjs_aio_ipm_send_async(TYPE_AIO_PIN_SUBSCRIBE, pin->pin, handle);
     }
 
     return ZJS_UNDEFINED;
@@ -293,9 +332,9 @@ static jerry_value_t zjs_aio_pin_read_async(const jerry_value_t function_obj,
     if (argc < 1 || !jerry_value_is_function(argv[0]))
         return zjs_error("zjs_aio_pin_read_async: invalid argument");
 
-    uint32_t device, pin;
-    zjs_obj_get_uint32(this, "device", &device);
-    zjs_obj_get_uint32(this, "pin", &pin);
+    aio_pin_t *pin = zjs_aio_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_aio_pin_read_async: not an AIO pin");
 
     aio_handle_t *handle = zjs_aio_alloc_handle();
     if (!handle)
@@ -307,10 +346,18 @@ static jerry_value_t zjs_aio_pin_read_async(const jerry_value_t function_obj,
                                            zjs_aio_free_callback);
 
     // send IPM message to the ARC side; response will come on an ISR
-    zjs_aio_ipm_send_async(TYPE_AIO_PIN_READ, pin, handle);
+    zjs_aio_ipm_send_async(TYPE_AIO_PIN_READ, pin->pin, handle);
     return ZJS_UNDEFINED;
 }
 
+static const zjs_native_func_t aio_pin_funcs[] = {
+    { zjs_aio_pin_read, "read" },
+    { zjs_aio_pin_read_async, "readAsync" },
+    { zjs_aio_pin_close, "close" },
+    { zjs_aio_pin_on, "on" },
+    { NULL, NULL }
+};
+
 static jerry_value_t zjs_aio_open(const jerry_value_t function_obj,
                                   const jerry_value_t this,
                                   const jerry_value_t argv[],
@@ -322,13 +369,20 @@ static jerry_value_t zjs_aio_open(const jerry_value_t function_obj,
     jerry_value_t data = argv[0];
 
     uint32_t device;
-    if (!zjs_obj_get_uint32(data, "device", &device))
+    if (!zjs_obj_get_uint32_id(data, ZJS_PROP_DEVICE, &device))
         return zjs_error("zjs_aio_open: missing required field (device)");
 
     uint32_t pin;
-    if (!zjs_obj_get_uint32(data, "pin", &pin))
+    if (!zjs_obj_get_uint32_id(data, ZJS_PROP_PIN, &pin))
         return zjs_error("zjs_aio_open: missing required field (pin)");
 
+    int devnum, newpin;
+    zjs_pin_convert(zjs_aio_pins, pin, &devnum, &newpin);
+    if (newpin == -1) {
+        DBG_PRINT("PIN: #%lu\n", pin);
+        return zjs_error("zjs_aio_open: pin out of range");
+    }
+
     const int BUFLEN = 32;
     char buffer[BUFLEN];
 
@@ -343,22 +397,28 @@ static jerry_value_t zjs_aio_open(const jerry_value_t function_obj,
     // send IPM message to the ARC side
     zjs_ipm_message_t* send = zjs_aio_alloc_msg();
     send->type = TYPE_AIO_OPEN;
-    send->data.aio.pin = pin;
+    send->data.aio.pin = newpin;
 
     jerry_value_t result = zjs_aio_call_remote_function(send);
     if (jerry_value_has_error_flag(result))
         return result;
 
+    aio_pin_t *pin_handle = zjs_malloc(sizeof(aio_pin_t));
+    if (!pin_handle)
+        return zjs_error("zjs_aio_open: could not allocate handle");
+    pin_handle->device = device;
+    pin_handle->pin = newpin;
+    pin_handle->change = NULL;
+
     // create the AIOPin object
-    jerry_value_t pinobj = jerry_create_object();
-    zjs_obj_add_function(pinobj, zjs_aio_pin_read, "read");
-    zjs_obj_add_function(pinobj, zjs_aio_pin_read_async, "readAsync");
-    zjs_obj_add_function(pinobj, zjs_aio_pin_close, "close");
-    zjs_obj_add_function(pinobj, zjs_aio_pin_on, "on");
+    jerry_value_t pinobj = zjs_create_instance(ZJS_CLASS_AIO_PIN,
+                                               aio_pin_funcs);
     zjs_obj_add_string(pinobj, name, "name");
-    zjs_obj_add_number(pinobj, device, "device");
-    zjs_obj_add_number(pinobj, pin, "pin");
+    zjs_obj_add_number_id(pinobj, device, ZJS_PROP_DEVICE);
+    zjs_obj_add_number_id(pinobj, pin, ZJS_PROP_PIN);
     zjs_obj_add_boolean(pinobj, raw, "raw");
+    jerry_set_object_native_handle(pinobj, (uintptr_t)pin_handle,
+                                   zjs_aio_free_pin);
 
     return pinobj;
 }
@@ -4,6 +4,10 @@
 #define __zjs_aio_h__
 
 #include "jerry-api.h"
+#include "zjs_pins.h"
+
+// pin map used to convert pin numbers in open(); defaults to the ARC inputs
+extern const zjs_pin_map_t *zjs_aio_pins;
 
 jerry_value_t zjs_aio_init();
 
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_BLE
 #ifdef BUILD_MODULE_BLE
 #ifndef QEMU_BUILD
 // Zephyr includes
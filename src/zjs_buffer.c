@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_BUFFER
 #ifdef BUILD_MODULE_BUFFER
 #ifndef ZJS_LINUX_BUILD
 // Zephyr includes
@@ -13,21 +14,53 @@
 // ZJS includes
 #include "zjs_util.h"
 #include "zjs_buffer.h"
+#include "zjs_codec.h"
+#include "zjs_pack.h"
+#include "zjs_scope.h"
 
-static zjs_buffer_t *zjs_buffers = NULL;
-
-// TODO: this could probably be replaced more efficiently now that there is a
-//   get_native_handle API
 zjs_buffer_t *zjs_buffer_find(const jerry_value_t obj)
 {
     // requires: obj should be the JS object associated with a buffer, created
     //             in zjs_buffer
-    //  effects: looks up obj in our list of known buffer objects and returns
-    //             the associated list item struct
-    for (zjs_buffer_t *buf = zjs_buffers; buf; buf = buf->next)
-        if (buf->obj == obj)
-            return buf;
-    return NULL;
+    //  effects: returns the buffer struct stored as obj's native handle
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_BUFFER) ||
+        !jerry_get_object_native_handle(obj, &native))
+        return NULL;
+    return (zjs_buffer_t *)native;
+}
+
+static bool zjs_buffer_get_offset(const jerry_value_t argv[],
+                                  const jerry_length_t argc, int index,
+                                  uint32_t def, uint32_t len, uint32_t *offset)
+{
+    // effects: sets offset to the number in argv[index] clamped to len, or to
+    //            def if not given; returns false if it isn't a number
+    if (argc <= index || jerry_value_is_undefined(argv[index])) {
+        *offset = def;
+        return true;
+    }
+    if (!jerry_value_is_number(argv[index]))
+        return false;
+    double value = jerry_get_number_value(argv[index]);
+    if (value < 0)
+        value = 0;
+    *offset = value > len ? len : (uint32_t)value;
+    return true;
+}
+
+static char *zjs_buffer_get_text(zjs_scope_t *scope, const jerry_value_t value,
+                                jerry_size_t *size)
+{
+    // requires: value is a string
+    //  effects: returns a copy of the string's bytes that lives until scope is
+    //             released, without a terminator, and sets size to their
+    //             number; returns NULL if out of memory
+    *size = jerry_get_string_size(value);
+    char *text = zjs_scope_alloc(scope, *size ? *size : 1);
+    if (text)
+        jerry_string_to_char_buffer(value, (jerry_char_t *)text, *size);
+    return text;
 }
 
 static jerry_value_t zjs_buffer_read_bytes(const jerry_value_t this,
@@ -198,12 +231,15 @@ static jerry_value_t zjs_buffer_write_uint32_le(const jerry_value_t function_obj
     return zjs_buffer_write_bytes(this, argv, argc, 4, false);
 }
 
-char zjs_int_to_hex(int value) {
-    // requires: value is between 0 and 15
-    //  effects: returns value as a lowercase hex digit 0-9a-f
-    if (value < 10)
-        return '0' + value;
-    return 'a' + value - 10;
+static zjs_encoding_t zjs_buffer_get_encoding(zjs_scope_t *scope,
+                                              const jerry_value_t value)
+{
+    // effects: returns the encoding named by the string value, or
+    //            ZJS_ENCODING_INVALID
+    char *name = zjs_scope_string(scope, value, 15);
+    if (!name)
+        return ZJS_ENCODING_INVALID;
+    return zjs_codec_lookup(name);
 }
 
 static jerry_value_t zjs_buffer_to_string(const jerry_value_t function_obj,
@@ -211,61 +247,54 @@ static jerry_value_t zjs_buffer_to_string(const jerry_value_t function_obj,
                                           const jerry_value_t argv[],
                                           const jerry_length_t argc)
 {
-    // requires: this must be a JS buffer object, if an argument is present it
-    //             must be the string 'hex', as that is the only supported
-    //             encoding for now
-    //  effects: if the buffer object is found, converts its contents to a hex
-    //             string and returns it in ret_val_p
-    if (argc > 1 || (argc == 1 && !jerry_value_is_string(argv[0])))
+    // requires: this must be a JS buffer object
+    //           arg[0] - encoding: 'utf8', 'ascii', 'hex' or 'base64'
+    //           arg[1] - offset to start at (Default: 0)
+    //           arg[2] - offset to stop at (Default: length)
+    //  effects: if the buffer object is found, returns the bytes in the range
+    //             converted to a string in the given encoding
+    if (argc >= 1 && !jerry_value_is_string(argv[0]))
         return zjs_error("zjs_buffer_to_string: invalid argument");
 
     zjs_buffer_t *buf = zjs_buffer_find(this);
-    if (buf && argc == 0) {
+    if (!buf)
+        return zjs_error("zjs_buffer_to_string: buffer not found");
+    if (argc == 0)
         return jerry_create_string((jerry_char_t *)"[Buffer Object]");
-    }
-
-    const int maxlen = 16;
-    char encoding[maxlen];
-    jerry_size_t sz = jerry_get_string_size(argv[0]);
-    if (sz >= maxlen) {
-        return zjs_error("zjs_buffer_to_string: encoding argument too long");
-    }
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)encoding,
-                                          sz);
-    encoding[len] = '\0';
 
-    if (strcmp(encoding, "hex"))
+    ZJS_SCOPE(scope);
+    zjs_encoding_t encoding = zjs_buffer_get_encoding(&scope, argv[0]);
+    if (encoding == ZJS_ENCODING_INVALID)
         return zjs_error("zjs_buffer_to_string: unsupported encoding type");
 
-    if (buf && buf->bufsize > 0) {
-        char hexbuf[buf->bufsize * 2 + 1];
-        for (int i=0; i<buf->bufsize; i++) {
-            int high = (0xf0 & buf->buffer[i]) >> 4;
-            int low = 0xf & buf->buffer[i];
-            hexbuf[2*i] = zjs_int_to_hex(high);
-            hexbuf[2*i+1] = zjs_int_to_hex(low);
-        }
-        hexbuf[buf->bufsize * 2] = '\0';
-        return jerry_create_string((jerry_char_t *)hexbuf);
-    }
+    uint32_t start, end;
+    if (!zjs_buffer_get_offset(argv, argc, 1, 0, buf->bufsize, &start) ||
+        !zjs_buffer_get_offset(argv, argc, 2, buf->bufsize, buf->bufsize,
+                               &end))
+        return zjs_error("zjs_buffer_to_string: invalid argument");
+    if (end < start)
+        end = start;
+
+    uint32_t max = zjs_codec_encoded_max(encoding, end - start);
+    char *str = zjs_scope_alloc(&scope, max ? max : 1);
+    if (!str)
+        return zjs_error("zjs_buffer_to_string: out of memory");
 
-    return zjs_error("zjs_buffer_to_string: buffer is empty");
+    uint32_t size = zjs_codec_encode(encoding, buf->buffer + start,
+                                     end - start, str);
+    return jerry_create_string_sz((jerry_char_t *)str, size);
 }
 
 static void zjs_buffer_callback_free(uintptr_t handle)
 {
     // requires: handle is the native pointer we registered with
     //             jerry_set_object_native_handle
-    //  effects: frees the callback list item for the given pin object
-    zjs_buffer_t **pItem = &zjs_buffers;
-    while (*pItem) {
-        if ((uintptr_t)*pItem == handle) {
-            zjs_free((*pItem)->buffer);
-            *pItem = (*pItem)->next;
-            zjs_free((void *)handle);
-        }
-        pItem = &(*pItem)->next;
+    //  effects: frees the buffer and its struct
+    zjs_buffer_t *buf = (zjs_buffer_t *)handle;
+    if (buf->buffer != (uint8_t *)(buf + 1)) {
+        zjs_free(buf->buffer);
     }
+    zjs_free(buf);
 }
 
 static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj_val,
@@ -276,110 +305,512 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj_va
     // requires: string - what will be written to buf
     //           offset - where to start writing (Default: 0)
     //           length - how many bytes to write (Default: buf.length -offset)
-    //           encoding - the character encoding of string. Currently only supports
-    //           the default of utf8
-    // effects: writes string to buf at offset according to the character encoding in encoding.
+    //           encoding - the character encoding of string: 'utf8'
+    //             (Default), 'ascii', 'hex' or 'base64'; it may follow the
+    //             string or either number instead
+    // effects: writes string to buf at offset according to the character
+    //            encoding in encoding, stopping before a character that
+    //            doesn't fit, and returns the number of bytes written
+    if (argc < 1 || !jerry_value_is_string(argv[0]))
+        return zjs_error("zjs_buffer_write_string: invalid argument");
 
-    if (argc < 1 || !jerry_value_is_string(argv[0]) ||
-        (argc > 1 && !jerry_value_is_number(argv[1])) ||
-        (argc > 2 && !jerry_value_is_number(argv[2])) ||
-        (argc > 3 && !jerry_value_is_string(argv[3])))
+    // the encoding is the first string after the one being written
+    int numbers = 1;
+    while (numbers < argc && numbers < 3 && jerry_value_is_number(argv[numbers]))
+        numbers++;
+    if (numbers < argc && !jerry_value_is_string(argv[numbers]))
         return zjs_error("zjs_buffer_write_string: invalid argument");
 
-    // Check if the encoding string is anything other than utf8
-    if (argc > 3) {
-        jerry_value_t arg4 = argv[3];
-        jerry_size_t arg4_sz = jerry_get_string_size(arg4);
+    ZJS_SCOPE(scope);
+    zjs_encoding_t encoding = ZJS_ENCODING_UTF8;
+    if (numbers < argc) {
+        encoding = zjs_buffer_get_encoding(&scope, argv[numbers]);
+        if (encoding == ZJS_ENCODING_INVALID)
+            return zjs_error("zjs_buffer_write_string: unsupported encoding type");
+    }
 
-        if (arg4_sz > 4096) {
-            return zjs_error("zjs_buffer_write_string: encoding arg string is too long");
-        }
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf) {
+        return zjs_error("zjs_buffer_write_string: buffer pointer not found");
+    }
 
-        char arg4_str[arg4_sz];
-        char utf8_str[4];
-        strcpy(utf8_str, "utf8");
-        uint8_t utf8 = strcmp(arg4_str, utf8_str);
+    // check the numbers as doubles, so negative, NaN and huge values can't
+    //   wrap around when they're cast
+    double start = 0;
+    if (numbers > 1)
+        start = jerry_get_number_value(argv[1]);
+    if (!(start >= 0 && start <= buf->bufsize))
+        return zjs_error("zjs_buffer_write_string: offset is beyond the buffer");
+    uint32_t offset = (uint32_t)start;
 
-        if (utf8 != 0) {
-            return zjs_error("zjs_buffer_write_string: only utf8 encoding is supported");
-        }
+    uint32_t length = buf->bufsize - offset;
+    if (numbers > 2) {
+        double most = jerry_get_number_value(argv[2]);
+        // most - most is NaN for infinity
+        if (!(most >= 0) || most - most != 0)
+            return zjs_error("zjs_buffer_write_string: invalid length");
+        if (most < length)
+            length = (uint32_t)most;
     }
 
-    uint32_t offset = 0;
-    jerry_value_t arg = argv[0];
-    jerry_size_t sz = jerry_get_string_size(arg);
-    zjs_buffer_t *buf = zjs_buffer_find(this);
+    jerry_size_t size;
+    char *text = zjs_buffer_get_text(&scope, argv[0], &size);
+    if (!text) {
+        return zjs_error("zjs_buffer_write_string: out of memory");
+    }
+
+    return jerry_create_number(zjs_codec_decode(encoding, text, size,
+                                                &buf->buffer[offset], length));
+}
+
+static bool zjs_buffer_get_bytes(zjs_scope_t *scope, const jerry_value_t value,
+                                 uint8_t *byte, const uint8_t **bytes,
+                                 uint32_t *len)
+{
+    // requires: byte is storage for a single byte value
+    //  effects: finds the bytes a number, string or Buffer value stands for,
+    //             as fill and indexOf take; returns false for other types
+    if (jerry_value_is_number(value)) {
+        *byte = (uint8_t)(uint32_t)jerry_get_number_value(value);
+        *bytes = byte;
+        *len = 1;
+        return true;
+    }
+    if (jerry_value_is_string(value)) {
+        char *str = zjs_scope_string(scope, value, ZJS_SCRATCH_SIZE);
+        if (!str)
+            return false;
+        *bytes = (uint8_t *)str;
+        *len = strlen(str);
+        return true;
+    }
+    zjs_buffer_t *buf = zjs_buffer_find(value);
+    if (!buf)
+        return false;
+    *bytes = buf->buffer;
+    *len = buf->bufsize;
+    return true;
+}
 
-    if (sz > 4096) {
-        return zjs_error("zjs_buffer_write_string: string is too long for the buffer");
+static int zjs_buffer_compare_bytes(const uint8_t *a, uint32_t alen,
+                                    const uint8_t *b, uint32_t blen)
+{
+    // effects: orders two byte strings like Buffer.compare, returning -1, 0
+    //            or 1
+    int result = memcmp(a, b, alen < blen ? alen : blen);
+    if (result)
+        return result < 0 ? -1 : 1;
+    if (alen == blen)
+        return 0;
+    return alen < blen ? -1 : 1;
+}
+
+static int32_t zjs_buffer_find_bytes(const uint8_t *hay, uint32_t haylen,
+                                     const uint8_t *needle, uint32_t nlen,
+                                     uint32_t start)
+{
+    // effects: returns the first offset at or after start where needle
+    //            appears in hay, or -1
+    if (nlen == 0)
+        return start <= haylen ? start : -1;
+    if (nlen > haylen)
+        return -1;
+
+    // memchr skips to candidates a word at a time, memcmp checks the rest
+    uint32_t last = haylen - nlen;
+    while (start <= last) {
+        const uint8_t *p = memchr(hay + start, needle[0], last - start + 1);
+        if (!p)
+            return -1;
+        if (!memcmp(p + 1, needle + 1, nlen - 1))
+            return p - hay;
+        start = p - hay + 1;
     }
+    return -1;
+}
 
-    char str[sz];
+static void zjs_buffer_fill_bytes(uint8_t *dst, uint32_t len,
+                                  const uint8_t *pattern, uint32_t patlen)
+{
+    // requires: patlen > 0; pattern may overlap dst
+    //  effects: repeats pattern through the len bytes at dst
+    if (patlen == 1) {
+        memset(dst, pattern[0], len);
+        return;
+    }
+    uint32_t done = patlen < len ? patlen : len;
+    memmove(dst, pattern, done);
+
+    // double the filled part each time so this takes log(len) copies
+    while (done < len) {
+        uint32_t chunk = done < len - done ? done : len - done;
+        memcpy(dst + done, dst, chunk);
+        done += chunk;
+    }
+}
 
-    if (!buf) {
-        return zjs_error("zjs_buffer_write_string: buffer pointer not found");
+static jerry_value_t zjs_buffer_copy(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    // requires: arg[0] - target Buffer
+    //           arg[1] - offset in target to copy to (Default: 0)
+    //           arg[2] - offset in this to copy from (Default: 0)
+    //           arg[3] - offset in this to stop copying at (Default: length)
+    //  effects: copies as many bytes as fit into target, and returns how many
+    //             were copied; the two may share memory
+    if (argc < 1)
+        return zjs_error("zjs_buffer_copy: missing target");
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    zjs_buffer_t *target = zjs_buffer_find(argv[0]);
+    if (!buf || !target)
+        return zjs_error("zjs_buffer_copy: buffer not found");
+
+    uint32_t target_start, start, end;
+    if (!zjs_buffer_get_offset(argv, argc, 1, 0, target->bufsize,
+                               &target_start) ||
+        !zjs_buffer_get_offset(argv, argc, 2, 0, buf->bufsize, &start) ||
+        !zjs_buffer_get_offset(argv, argc, 3, buf->bufsize, buf->bufsize,
+                               &end))
+        return zjs_error("zjs_buffer_copy: invalid argument");
+
+    uint32_t count = end > start ? end - start : 0;
+    if (count > target->bufsize - target_start)
+        count = target->bufsize - target_start;
+
+    memmove(target->buffer + target_start, buf->buffer + start, count);
+    return jerry_create_number(count);
+}
+
+static jerry_value_t zjs_buffer_fill(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    // requires: arg[0] - byte value, string or Buffer to fill with
+    //           arg[1] - offset to start at (Default: 0)
+    //           arg[2] - offset to stop at (Default: length)
+    //  effects: fills the range with the value, repeating it as needed, and
+    //             returns this
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_fill: buffer not found");
+
+    ZJS_SCOPE(scope);
+    uint8_t byte;
+    const uint8_t *bytes;
+    uint32_t len, start, end;
+    if (argc < 1 ||
+        !zjs_buffer_get_bytes(&scope, argv[0], &byte, &bytes, &len) ||
+        !zjs_buffer_get_offset(argv, argc, 1, 0, buf->bufsize, &start) ||
+        !zjs_buffer_get_offset(argv, argc, 2, buf->bufsize, buf->bufsize,
+                               &end))
+        return zjs_error("zjs_buffer_fill: invalid argument");
+
+    if (len == 0) {
+        // an empty pattern fills with zeros, as node.js does
+        byte = 0;
+        bytes = &byte;
+        len = 1;
     }
+    if (end > start)
+        zjs_buffer_fill_bytes(buf->buffer + start, end - start, bytes, len);
 
-    if (argc > 1)
+    return jerry_acquire_value(this);
+}
+
+static jerry_value_t zjs_buffer_compare(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    // requires: arg[0] - Buffer to compare with
+    //  effects: returns -1, 0 or 1 as this sorts before, the same as or after
+    //             the other Buffer
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    zjs_buffer_t *other = argc < 1 ? NULL : zjs_buffer_find(argv[0]);
+    if (!buf || !other)
+        return zjs_error("zjs_buffer_compare: invalid argument");
+
+    return jerry_create_number(zjs_buffer_compare_bytes(buf->buffer,
+                                                        buf->bufsize,
+                                                        other->buffer,
+                                                        other->bufsize));
+}
+
+static jerry_value_t zjs_buffer_equals(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    // requires: arg[0] - Buffer to compare with
+    //  effects: returns true if both Buffers hold the same bytes
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    zjs_buffer_t *other = argc < 1 ? NULL : zjs_buffer_find(argv[0]);
+    if (!buf || !other)
+        return zjs_error("zjs_buffer_equals: invalid argument");
+
+    return jerry_create_boolean(buf->bufsize == other->bufsize &&
+                                !memcmp(buf->buffer, other->buffer,
+                                        buf->bufsize));
+}
+
+static jerry_value_t zjs_buffer_index_of(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // requires: arg[0] - byte value, string or Buffer to look for
+    //           arg[1] - offset to start looking at (Default: 0)
+    //  effects: returns the offset of the first match, or -1
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_index_of: buffer not found");
+
+    ZJS_SCOPE(scope);
+    uint8_t byte;
+    const uint8_t *bytes;
+    uint32_t len, start;
+    if (argc < 1 ||
+        !zjs_buffer_get_bytes(&scope, argv[0], &byte, &bytes, &len) ||
+        !zjs_buffer_get_offset(argv, argc, 1, 0, buf->bufsize, &start))
+        return zjs_error("zjs_buffer_index_of: invalid argument");
+
+    return jerry_create_number(zjs_buffer_find_bytes(buf->buffer, buf->bufsize,
+                                                     bytes, len, start));
+}
+
+static const zjs_pack_format_t *zjs_buffer_get_format(zjs_scope_t *scope,
+                                                      const jerry_value_t value)
+{
+    // effects: returns the parsed pack format in the string value, or NULL
+    char *text = zjs_scope_string(scope, value, ZJS_PACK_FORMAT_MAX - 1);
+    if (!text)
+        return NULL;
+    return zjs_pack_lookup(text);
+}
+
+static jerry_value_t zjs_buffer_unpack(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    // requires: arg[0] - format string, as described in zjs_pack.h
+    //           arg[1] - offset of the record (Default: 0)
+    //  effects: decodes the record at offset and returns its fields as an
+    //             array of numbers
+    if (argc < 1 || !jerry_value_is_string(argv[0]) ||
+        (argc >= 2 && !jerry_value_is_number(argv[1])))
+        return zjs_error("zjs_buffer_unpack: invalid argument");
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_unpack: buffer not found");
+
+    ZJS_SCOPE(scope);
+    const zjs_pack_format_t *format = zjs_buffer_get_format(&scope, argv[0]);
+    if (!format)
+        return zjs_error("zjs_buffer_unpack: invalid format");
+
+    uint32_t offset = 0;
+    if (argc >= 2)
         offset = (uint32_t)jerry_get_number_value(argv[1]);
+    if (offset > buf->bufsize || format->size > buf->bufsize - offset)
+        return zjs_error("zjs_buffer_unpack: read attempted beyond buffer");
+
+    double *values = zjs_scope_alloc(&scope,
+                                     format->value_count * sizeof(double));
+    if (!values && format->value_count)
+        return zjs_error("zjs_buffer_unpack: out of memory");
+    zjs_pack_read(format, buf->buffer + offset, values);
+
+    jerry_value_t array = jerry_create_array(format->value_count);
+    for (int i = 0; i < format->value_count; i++) {
+        jerry_value_t num = jerry_create_number(values[i]);
+        jerry_set_property_by_index(array, i, num);
+        jerry_release_value(num);
+    }
+    return array;
+}
 
-    uint32_t length = buf->bufsize - offset;
+static jerry_value_t zjs_buffer_pack(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    // requires: arg[0] - format string, as described in zjs_pack.h
+    //           arg[1] - array with a number for each field
+    //           arg[2] - offset to write the record at (Default: 0)
+    //  effects: encodes the values as a record at offset, and returns the
+    //             offset just past it
+    if (argc < 2 || !jerry_value_is_string(argv[0]) ||
+        !jerry_value_is_array(argv[1]) ||
+        (argc >= 3 && !jerry_value_is_number(argv[2])))
+        return zjs_error("zjs_buffer_pack: invalid argument");
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_pack: buffer not found");
+
+    ZJS_SCOPE(scope);
+    const zjs_pack_format_t *cached = zjs_buffer_get_format(&scope, argv[0]);
+    if (!cached)
+        return zjs_error("zjs_buffer_pack: invalid format");
 
-    if (argc > 2)
-        length = (uint32_t)jerry_get_number_value(argv[2]);
+    // reading the values can run a getter that packs other formats and
+    //   evicts this one from the cache, so work from a copy
+    zjs_pack_format_t copy = *cached;
+    const zjs_pack_format_t *format = &copy;
+
+    uint32_t offset = 0;
+    if (argc >= 3)
+        offset = (uint32_t)jerry_get_number_value(argv[2]);
+    if (offset > buf->bufsize || format->size > buf->bufsize - offset)
+        return zjs_error("zjs_buffer_pack: write attempted beyond buffer");
+
+    if (jerry_get_array_length(argv[1]) < format->value_count)
+        return zjs_error("zjs_buffer_pack: not enough values for format");
+
+    double *values = zjs_scope_alloc(&scope,
+                                     format->value_count * sizeof(double));
+    if (!values && format->value_count)
+        return zjs_error("zjs_buffer_pack: out of memory");
+    for (int i = 0; i < format->value_count; i++) {
+        jerry_value_t item = jerry_get_property_by_index(argv[1], i);
+        bool is_number = jerry_value_is_number(item);
+        if (is_number)
+            values[i] = jerry_get_number_value(item);
+        jerry_release_value(item);
+        if (!is_number)
+            return zjs_error("zjs_buffer_pack: values must be numbers");
+    }
+
+    zjs_pack_write(format, values, buf->buffer + offset);
+    return jerry_create_number(offset + format->size);
+}
+
+// A view shares part of another Buffer's data, and holds a reference to that
+//   Buffer so the data outlives it
+typedef struct buffer_view {
+    zjs_buffer_t buf;               // must be first, it's what find returns
+    jerry_value_t parent;
+} buffer_view_t;
+
+static void zjs_buffer_view_free(uintptr_t handle)
+{
+    buffer_view_t *view = (buffer_view_t *)handle;
+    jerry_release_value(view->parent);
+    zjs_free(view);
+}
 
-    if (offset + length > buf->bufsize) {
-        return zjs_error("zjs_buffer_write_string: string + offset is larger than the buffer");
+static uint32_t zjs_buffer_index(const jerry_value_t arg, uint32_t len)
+{
+    // effects: converts a slice index argument to an offset within len bytes,
+    //            counting back from the end if negative; NaN counts as 0, as
+    //            in node
+    double index = jerry_get_number_value(arg);
+    if (index != index)
+        index = 0;
+    if (index < 0) {
+        index += len;
+        if (index < 0)
+            index = 0;
     }
+    if (index > len)
+        index = len;
+    return (uint32_t)index;
+}
 
-    jerry_string_to_char_buffer(arg, str, sz);
+static jerry_value_t zjs_buffer_slice(const jerry_value_t function_obj,
+                                      const jerry_value_t this,
+                                      const jerry_value_t argv[],
+                                      const jerry_length_t argc)
+{
+    // requires: this is a Buffer, optional start and end offsets, negative
+    //             ones counted from the end
+    //  effects: returns a new Buffer that shares the bytes from start up to
+    //             but not including end; no data is copied
+    if ((argc >= 1 && !jerry_value_is_number(argv[0])) ||
+        (argc >= 2 && !jerry_value_is_number(argv[1])))
+        return zjs_error("zjs_buffer_slice: invalid argument");
 
-    memcpy(&buf->buffer[offset], &str[0], length);
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_slice: buffer not found");
 
-    return jerry_create_number(length);
+    uint32_t start = 0, end = buf->bufsize;
+    if (argc >= 1)
+        start = zjs_buffer_index(argv[0], buf->bufsize);
+    if (argc >= 2)
+        end = zjs_buffer_index(argv[1], buf->bufsize);
+    if (end < start)
+        end = start;
+
+    jerry_value_t view = zjs_buffer_create_view(this, start, end - start);
+    if (!jerry_value_is_object(view))
+        return zjs_error("zjs_buffer_slice: unable to allocate view");
+    return view;
 }
 
+static const zjs_native_func_t buffer_funcs[] = {
+    { zjs_buffer_read_uint8, "readUInt8" },
+    { zjs_buffer_write_uint8, "writeUInt8" },
+    { zjs_buffer_read_uint16_be, "readUInt16BE" },
+    { zjs_buffer_write_uint16_be, "writeUInt16BE" },
+    { zjs_buffer_read_uint16_le, "readUInt16LE" },
+    { zjs_buffer_write_uint16_le, "writeUInt16LE" },
+    { zjs_buffer_read_uint32_be, "readUInt32BE" },
+    { zjs_buffer_write_uint32_be, "writeUInt32BE" },
+    { zjs_buffer_read_uint32_le, "readUInt32LE" },
+    { zjs_buffer_write_uint32_le, "writeUInt32LE" },
+    { zjs_buffer_to_string, "toString" },
+    { zjs_buffer_write_string, "write" },
+    { zjs_buffer_copy, "copy" },
+    { zjs_buffer_fill, "fill" },
+    { zjs_buffer_compare, "compare" },
+    { zjs_buffer_equals, "equals" },
+    { zjs_buffer_index_of, "indexOf" },
+    { zjs_buffer_pack, "pack" },
+    { zjs_buffer_unpack, "unpack" },
+    { zjs_buffer_slice, "slice" },
+    { zjs_buffer_slice, "subarray" },
+    { NULL, NULL }
+};
+
 jerry_value_t zjs_buffer_create(uint32_t size)
 {
     // requires: size is size of desired buffer, in bytes
-    //  effects: allocates a JS Buffer object, an underlying C buffer, and a
-    //             list item to track it; if any of these fail, free them all
-    //             and return NULL, otherwise return the JS object
-    jerry_value_t buf_obj = jerry_create_object();
-    void *buf = zjs_malloc(size);
+    //  effects: allocates a JS Buffer object, and a struct to track it
+    //             followed by the C buffer, or with a separate C buffer if
+    //             it's large; if any of these fail, free them all and return
+    //             undefined, otherwise return the JS object
+    jerry_value_t buf_obj = zjs_create_instance(ZJS_CLASS_BUFFER,
+                                                buffer_funcs);
+    bool inline_data = size <= ZJS_BUFFER_INLINE_MAX;
     zjs_buffer_t *buf_item =
-        (zjs_buffer_t *)zjs_malloc(sizeof(zjs_buffer_t));
+        (zjs_buffer_t *)zjs_malloc(sizeof(zjs_buffer_t) +
+                                   (inline_data ? size : 0));
+    void *buf = NULL;
+    if (buf_item) {
+        buf = inline_data ? buf_item + 1 : zjs_malloc(size);
+    }
 
     if (!buf_obj || !buf || !buf_item) {
         PRINT("zjs_buffer_create: unable to allocate buffer\n");
         jerry_release_value(buf_obj);
-        zjs_free(buf);
+        if (!inline_data) {
+            zjs_free(buf);
+        }
         zjs_free(buf_item);
         return ZJS_UNDEFINED;
     }
 
-    buf_item->obj = buf_obj;
     buf_item->buffer = buf;
     buf_item->bufsize = size;
-    buf_item->next = zjs_buffers;
-    zjs_buffers = buf_item;
 
     zjs_obj_add_number(buf_obj, size, "length");
-    zjs_obj_add_function(buf_obj, zjs_buffer_read_uint8, "readUInt8");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_uint8, "writeUInt8");
-    zjs_obj_add_function(buf_obj, zjs_buffer_read_uint16_be, "readUInt16BE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_uint16_be, "writeUInt16BE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_read_uint16_le, "readUInt16LE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_uint16_le, "writeUInt16LE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_read_uint32_be, "readUInt32BE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_uint32_be, "writeUInt32BE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_read_uint32_le, "readUInt32LE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_uint32_le, "writeUInt32LE");
-    zjs_obj_add_function(buf_obj, zjs_buffer_to_string, "toString");
-    zjs_obj_add_function(buf_obj, zjs_buffer_write_string, "write");
-
-    // TODO: sign up to get callback when the object is freed, then free the
-    //   buffer and remove it from the list
 
     // watch for the object getting garbage collected, and clean up
     jerry_set_object_native_handle(buf_obj, (uintptr_t)buf_item,
@@ -388,21 +819,51 @@ jerry_value_t zjs_buffer_create(uint32_t size)
     return buf_obj;
 }
 
+jerry_value_t zjs_buffer_create_view(jerry_value_t parent, uint32_t offset,
+                                     uint32_t length)
+{
+    zjs_buffer_t *buf = zjs_buffer_find(parent);
+    if (!buf || offset > buf->bufsize || length > buf->bufsize - offset)
+        return ZJS_UNDEFINED;
+
+    jerry_value_t view_obj = zjs_create_instance(ZJS_CLASS_BUFFER,
+                                                 buffer_funcs);
+    buffer_view_t *view = zjs_malloc(sizeof(buffer_view_t));
+    if (!view_obj || !view) {
+        PRINT("zjs_buffer_create_view: unable to allocate view\n");
+        jerry_release_value(view_obj);
+        zjs_free(view);
+        return ZJS_UNDEFINED;
+    }
+
+    view->buf.buffer = buf->buffer + offset;
+    view->buf.bufsize = length;
+    view->parent = jerry_acquire_value(parent);
+
+    zjs_obj_add_number(view_obj, length, "length");
+    jerry_set_object_native_handle(view_obj, (uintptr_t)view,
+                                   zjs_buffer_view_free);
+    return view_obj;
+}
+
 // Buffer constructor
 static jerry_value_t zjs_buffer(const jerry_value_t function_obj,
                                 const jerry_value_t this,
                                 const jerry_value_t argv[],
                                 const jerry_length_t argc)
 {
-    // requires: single argument can be a numeric size in bytes, an array of uint8,
-    //           or a string.
+    // requires: single argument can be a numeric size in bytes, an array of
+    //             uint8, or a string; a string may be followed by its
+    //             encoding, as for write
     //  effects: constructs a new JS Buffer object, and an associated buffer
-    //             tied to it through a zjs_buffer_t struct stored in a global
-    //             list
-    if (argc != 1 ||
+    //             tied to it through a zjs_buffer_t struct stored as its
+    //             native handle
+    if (argc < 1 || argc > 2 ||
         !(jerry_value_is_number(argv[0]) ||
         jerry_value_is_array(argv[0]) ||
-        jerry_value_is_string(argv[0])))
+        jerry_value_is_string(argv[0])) ||
+        (argc == 2 && !(jerry_value_is_string(argv[0]) &&
+                        jerry_value_is_string(argv[1]))))
         return zjs_error("zjs_buffer: invalid argument");
 
     if (jerry_value_is_number(argv[0])) {
@@ -433,14 +894,28 @@ static jerry_value_t zjs_buffer(const jerry_value_t function_obj,
         }
         return new_buf_obj;
     } else {
-        // If passed a string, convert it into a char array and copy it to the buffer.
-        jerry_value_t arg = argv[0];
-        jerry_size_t sz = jerry_get_string_size(arg);
-        jerry_value_t new_buf_obj = zjs_buffer_create(sz);
+        // If passed a string, decode it into a buffer of just the right size
+        ZJS_SCOPE(scope);
+        zjs_encoding_t encoding = ZJS_ENCODING_UTF8;
+        if (argc == 2) {
+            encoding = zjs_buffer_get_encoding(&scope, argv[1]);
+            if (encoding == ZJS_ENCODING_INVALID)
+                return zjs_error("zjs_buffer: unsupported encoding type");
+        }
+
+        jerry_size_t sz;
+        char *text = zjs_buffer_get_text(&scope, argv[0], &sz);
+        if (!text) {
+            return zjs_error("zjs_buffer: out of memory");
+        }
+
+        uint32_t count = zjs_codec_decode(encoding, text, sz, NULL,
+                                          UINT32_MAX);
+        jerry_value_t new_buf_obj = zjs_buffer_create(count);
         zjs_buffer_t *buf = zjs_buffer_find(new_buf_obj);
 
         if (buf) {
-            jerry_string_to_char_buffer(arg, (char*)buf->buffer, sz);
+            zjs_codec_decode(encoding, text, sz, buf->buffer, count);
         } else {
             return zjs_error("zjs_buffer: unable to find string buffer");
         }
@@ -449,9 +924,77 @@ static jerry_value_t zjs_buffer(const jerry_value_t function_obj,
     }
 }
 
+static jerry_value_t zjs_buffer_concat(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    // requires: arg[0] - array of Buffers
+    //           arg[1] - length of the result (Default: sum of the lengths)
+    //  effects: returns a new Buffer holding the Buffers one after another,
+    //             cut off or zero padded to the length
+    if (argc < 1 || !jerry_value_is_array(argv[0]) ||
+        (argc >= 2 && !jerry_value_is_number(argv[1])))
+        return zjs_error("zjs_buffer_concat: invalid argument");
+
+    // hold on to the Buffers from the first pass, since a getter on the
+    //   list could swap them out before the second
+    uint32_t count = jerry_get_array_length(argv[0]);
+    ZJS_SCOPE(scope);
+    jerry_value_t *items = zjs_scope_alloc(&scope,
+                                           count * sizeof(jerry_value_t));
+    zjs_buffer_t **bufs = zjs_scope_alloc(&scope,
+                                          count * sizeof(zjs_buffer_t *));
+    if ((!items || !bufs) && count)
+        return zjs_error("zjs_buffer_concat: out of memory");
+
+    uint32_t total = 0;
+    jerry_value_t ret_val = ZJS_UNDEFINED;
+    uint32_t held;
+    for (held = 0; held < count; held++) {
+        items[held] = jerry_get_property_by_index(argv[0], held);
+        zjs_buffer_t *buf = bufs[held] = zjs_buffer_find(items[held]);
+        if (!buf) {
+            jerry_release_value(items[held]);
+            ret_val = zjs_error("zjs_buffer_concat: list must hold Buffers");
+            break;
+        }
+        total += buf->bufsize;
+    }
+    if (held == count) {
+        if (argc >= 2)
+            total = (uint32_t)jerry_get_number_value(argv[1]);
+        ret_val = zjs_buffer_create(total);
+        zjs_buffer_t *new_buf = zjs_buffer_find(ret_val);
+        if (new_buf) {
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < count && offset < total; i++) {
+                uint32_t size = bufs[i]->bufsize;
+                if (size > total - offset)
+                    size = total - offset;
+                memcpy(new_buf->buffer + offset, bufs[i]->buffer, size);
+                offset += size;
+            }
+            memset(new_buf->buffer + offset, 0, total - offset);
+        } else {
+            jerry_release_value(ret_val);
+            ret_val = zjs_error("zjs_buffer_concat: unable to allocate buffer");
+        }
+    }
+
+    for (uint32_t i = 0; i < held; i++) {
+        jerry_release_value(items[i]);
+    }
+    return ret_val;
+}
+
 void zjs_buffer_init()
 {
     jerry_value_t global_obj = jerry_get_global_object();
-    zjs_obj_add_function(global_obj, zjs_buffer, "Buffer");
+    jerry_value_t buffer_func = jerry_create_external_function(zjs_buffer);
+    zjs_obj_add_function(buffer_func, zjs_buffer_concat, "concat");
+    zjs_set_property(global_obj, "Buffer", buffer_func);
+    jerry_release_value(buffer_func);
+    jerry_release_value(global_obj);
 }
 #endif // BUILD_MODULE_BUFFER
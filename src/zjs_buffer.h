@@ -7,15 +7,33 @@
 
 void zjs_buffer_init();
 
+// Payloads up to this size are stored right after the zjs_buffer_t in the
+//   same allocation; larger ones get a block of their own. With the pool
+//   allocator this keeps header plus payload within the largest pool (256),
+//   leaving room for the memory stats header.
+#ifndef ZJS_BUFFER_INLINE_MAX
+#ifdef ZJS_POOL_CONFIG
+#define ZJS_BUFFER_INLINE_MAX 240
+#else
+#define ZJS_BUFFER_INLINE_MAX 1024
+#endif
+#endif
+
 typedef struct zjs_buffer {
-    jerry_value_t obj;
-    uint8_t *buffer;
+    uint8_t *buffer;                // points just past this struct if inline
     uint32_t bufsize;
-    struct zjs_buffer *next;
 } zjs_buffer_t;
 
+// effects: returns the native buffer of a Buffer object, or NULL if obj isn't
+//            one; this is a constant time lookup through the native handle
 zjs_buffer_t *zjs_buffer_find(const jerry_value_t obj);
 
 jerry_value_t zjs_buffer_create(uint32_t size);
 
+// requires: parent is a Buffer object, offset + length is within it
+//  effects: returns a new Buffer object sharing length bytes of parent's data
+//             starting at offset; parent is kept alive as long as the view
+jerry_value_t zjs_buffer_create_view(jerry_value_t parent, uint32_t offset,
+                                     uint32_t length);
+
 #endif  // __zjs_buffer_h__
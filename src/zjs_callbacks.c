@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_CALLBACKS
 
 #ifndef ZJS_LINUX_BUILD
 #include <zephyr.h>
@@ -7,10 +8,15 @@
 
 #include "zjs_util.h"
 #include "zjs_callbacks.h"
+#include "zjs_gc.h"
+#include "zjs_scope.h"
 
 #include "jerry-api.h"
 
+// scripts/analyze.sh sizes this to the callbacks the script is expected to use
+#ifndef INITIAL_CALLBACK_SIZE
 #define INITIAL_CALLBACK_SIZE  16
+#endif
 #define CB_CHUNK_SIZE          16
 
 #define CALLBACK_TYPE_JS    0
@@ -47,33 +53,91 @@ struct zjs_callback_map {
 };
 
 static int32_t cb_limit = INITIAL_CALLBACK_SIZE;
+// one past the highest ID in use
 static int32_t cb_size = 0;
 static struct zjs_callback_map** cb_map = NULL;
+// the map can be freed and allocated again, but the trim only goes in once
+static bool trim_registered = false;
+
+// exceptions thrown out of callbacks, where no script code can catch them
+static uint32_t uncaught_errors = 0;
+
+static bool resize_map(int32_t limit)
+{
+    // requires: limit is at least cb_size
+    //  effects: moves cb_map to a new allocation with room for limit entries
+    size_t size = sizeof(struct zjs_callback_map *) * limit;
+    struct zjs_callback_map** new_map = zjs_malloc(size);
+    if (!new_map) {
+        DBG_PRINT("error allocating space for new callback map\n");
+        return false;
+    }
+    memset(new_map, 0, size);
+    memcpy(new_map, cb_map, sizeof(struct zjs_callback_map *) * cb_size);
+    zjs_free(cb_map);
+    cb_map = new_map;
+    cb_limit = limit;
+    return true;
+}
 
 static int32_t new_id(void)
 {
-    int32_t id = 0;
-    if (cb_size >= cb_limit) {
-        cb_limit += CB_CHUNK_SIZE;
-        size_t size = sizeof(struct zjs_callback_map *) * cb_limit;
-        struct zjs_callback_map** new_map = zjs_malloc(size);
-        if (!new_map) {
-            DBG_PRINT("error allocating space for new callback map\n");
+    // requires: the caller has made every allocation it needs, and stores the
+    //             ID with set_callback before allocating again; otherwise a GC
+    //             pass could trim the map back below the new ID
+    // the map is only allocated once a script actually registers a callback
+    if (!cb_map) {
+        zjs_init_callbacks();
+        if (!cb_map) {
             return -1;
         }
-        DBG_PRINT("callback list size too small, increasing by %d\n",
-                  CB_CHUNK_SIZE);
-        memset(new_map, 0, size);
-        memcpy(new_map, cb_map, sizeof(struct zjs_callback_map *) * cb_size);
-        zjs_free(cb_map);
-        cb_map = new_map;
     }
-    while (cb_map[id] != NULL) {
+
+    int32_t id = 0;
+    while (id < cb_size && cb_map[id] != NULL) {
         id++;
     }
+    if (id >= cb_limit) {
+        DBG_PRINT("callback list size too small, increasing by %d\n",
+                  CB_CHUNK_SIZE);
+        if (!resize_map(cb_limit + CB_CHUNK_SIZE)) {
+            return -1;
+        }
+    }
     return id;
 }
 
+static bool valid_id(int32_t id)
+{
+    // effects: returns true if id is within the map; native free callbacks
+    //            can still pass IDs in after zjs_callbacks_cleanup emptied it
+    return id >= 0 && id < cb_size;
+}
+
+static void set_callback(int32_t id, struct zjs_callback_map *cb)
+{
+    cb_map[id] = cb;
+    if (id >= cb_size) {
+        cb_size = id + 1;
+    }
+}
+
+static void zjs_callbacks_trim(void)
+{
+    // effects: gives back whole unused chunks at the end of the callback map
+    if (!cb_map) {
+        return;
+    }
+    int32_t limit = cb_size + CB_CHUNK_SIZE - 1;
+    limit -= limit % CB_CHUNK_SIZE;
+    if (limit < INITIAL_CALLBACK_SIZE) {
+        limit = INITIAL_CALLBACK_SIZE;
+    }
+    if (limit < cb_limit) {
+        resize_map(limit);
+    }
+}
+
 void zjs_init_callbacks(void)
 {
     if (!cb_map) {
@@ -85,13 +149,30 @@ void zjs_init_callbacks(void)
             return;
         }
         memset(cb_map, 0, size);
+        if (!trim_registered) {
+            zjs_gc_register_trim(zjs_callbacks_trim);
+            trim_registered = true;
+        }
     }
     return;
 }
 
+void zjs_callbacks_cleanup(void)
+{
+    // effects: removes every callback, releasing the JS values they hold, and
+    //            frees the map
+    for (int32_t id = cb_size - 1; id >= 0; id--) {
+        zjs_remove_callback(id);
+    }
+    zjs_free(cb_map);
+    cb_map = NULL;
+    cb_size = 0;
+    cb_limit = INITIAL_CALLBACK_SIZE;
+}
+
 void zjs_edit_js_func(int32_t id, jerry_value_t func)
 {
-    if (id != -1) {
+    if (valid_id(id)) {
         jerry_release_value(cb_map[id]->js->js_func);
         cb_map[id]->js->js_func = jerry_acquire_value(func);
     }
@@ -99,7 +180,7 @@ void zjs_edit_js_func(int32_t id, jerry_value_t func)
 
 void zjs_edit_callback_handle(int32_t id, void* handle)
 {
-    if (id != -1) {
+    if (valid_id(id)) {
         if (cb_map[id]->type == CALLBACK_TYPE_JS) {
             if (cb_map[id]->js) {
                 cb_map[id]->js->handle = handle;
@@ -112,7 +193,7 @@ void zjs_edit_callback_handle(int32_t id, void* handle)
 
 bool zjs_remove_callback_list_func(int32_t id, jerry_value_t js_func)
 {
-    if (id != -1 && cb_map[id] && cb_map[id]->js) {
+    if (valid_id(id) && cb_map[id] && cb_map[id]->js) {
         int i;
         for (i = 0; i < cb_map[id]->js->num_funcs; ++i) {
             if (js_func == cb_map[id]->js->func_list[i]) {
@@ -132,7 +213,7 @@ bool zjs_remove_callback_list_func(int32_t id, jerry_value_t js_func)
 
 int zjs_get_num_callbacks(int32_t id)
 {
-    if (id != -1) {
+    if (valid_id(id)) {
         if (cb_map[id] && cb_map[id]->js) {
             return cb_map[id]->js->num_funcs;
         }
@@ -142,7 +223,7 @@ int zjs_get_num_callbacks(int32_t id)
 
 jerry_value_t* zjs_get_callback_func_list(int32_t id, int* count)
 {
-    if (id != -1) {
+    if (valid_id(id)) {
         if (cb_map[id] && cb_map[id]->js) {
             *count = cb_map[id]->js->num_funcs;
             return cb_map[id]->js->func_list;
@@ -208,22 +289,29 @@ int32_t zjs_add_callback_list(jerry_value_t js_func,
             zjs_free(new_cb);
             return -1;
         }
+        new_cb->js->func_list = zjs_malloc(sizeof(jerry_value_t) * CB_LIST_MULTIPLIER);
+        if (!new_cb->js->func_list) {
+            DBG_PRINT("could not allocate function list\n");
+            zjs_free(new_cb->js);
+            zjs_free(new_cb);
+            return -1;
+        }
         new_cb->type = CALLBACK_TYPE_JS;
         new_cb->signal = 0;
         new_cb->js->id = new_id();
+        if (new_cb->js->id == -1) {
+            zjs_free(new_cb->js->func_list);
+            zjs_free(new_cb->js);
+            zjs_free(new_cb);
+            return -1;
+        }
         new_cb->js->pre = pre;
         new_cb->js->post = post;
         new_cb->js->handle = handle;
         new_cb->js->max_funcs = CB_LIST_MULTIPLIER;
         new_cb->js->num_funcs = 1;
-        new_cb->js->func_list = zjs_malloc(sizeof(jerry_value_t) * CB_LIST_MULTIPLIER);
-        if (!new_cb->js->func_list) {
-            DBG_PRINT("could not allocate function list\n");
-            return -1;
-        }
         new_cb->js->func_list[0] = jerry_acquire_value(js_func);
-        cb_map[new_cb->js->id] = new_cb;
-        cb_size++;
+        set_callback(new_cb->js->id, new_cb);
         return new_cb->js->id;
     }
 }
@@ -249,6 +337,11 @@ int32_t add_callback(jerry_value_t js_func,
     new_cb->type = CALLBACK_TYPE_JS;
     new_cb->signal = 0;
     new_cb->js->id = new_id();
+    if (new_cb->js->id == -1) {
+        zjs_free(new_cb->js);
+        zjs_free(new_cb);
+        return -1;
+    }
     new_cb->js->js_func = jerry_acquire_value(js_func);
     new_cb->js->this = this;
     new_cb->js->pre = pre;
@@ -260,8 +353,7 @@ int32_t add_callback(jerry_value_t js_func,
     new_cb->js->once = once;
 
     // Add callback to list
-    cb_map[new_cb->js->id] = new_cb;
-    cb_size++;
+    set_callback(new_cb->js->id, new_cb);
 
     DBG_PRINT("adding new callback id %ld, js_func=%lu, once=%u\n",
               new_cb->js->id, new_cb->js->js_func, once);
@@ -289,7 +381,7 @@ int32_t zjs_add_callback_once(jerry_value_t js_func,
 
 void zjs_remove_callback(int32_t id)
 {
-    if (id != -1 && cb_map[id]) {
+    if (valid_id(id) && cb_map[id]) {
         if (cb_map[id]->type == CALLBACK_TYPE_JS && cb_map[id]->js) {
             if (cb_map[id]->js->func_list) {
                 int i;
@@ -306,13 +398,16 @@ void zjs_remove_callback(int32_t id)
         }
         zjs_free(cb_map[id]);
         cb_map[id] = NULL;
+        while (cb_size > 0 && cb_map[cb_size - 1] == NULL) {
+            cb_size--;
+        }
         DBG_PRINT("removing callback id %ld\n", id);
     }
 }
 
 void zjs_signal_callback(int32_t id)
 {
-    if (id != -1 && cb_map[id]) {
+    if (valid_id(id) && cb_map[id]) {
 #ifdef DEBUG_BUILD
         if (cb_map[id]->type == CALLBACK_TYPE_JS) {
             DBG_PRINT("signaling JS callback id %ld\n", id);
@@ -340,12 +435,16 @@ int32_t zjs_add_c_callback(void* handle, zjs_c_callback_func callback)
     new_cb->type = CALLBACK_TYPE_C;
     new_cb->signal = 0;
     new_cb->c->id = new_id();
+    if (new_cb->c->id == -1) {
+        zjs_free(new_cb->c);
+        zjs_free(new_cb);
+        return -1;
+    }
     new_cb->c->function = callback;
     new_cb->c->handle = handle;
 
     // Add callback to list
-    cb_map[new_cb->c->id] = new_cb;
-    cb_size++;
+    set_callback(new_cb->c->id, new_cb);
 
     DBG_PRINT("adding new C callback id %ld\n", new_cb->c->id);
 
@@ -381,6 +480,29 @@ void print_callbacks(void)
 #define print_callbacks() do {} while (0)
 #endif
 
+static void check_uncaught(jerry_value_t ret_val)
+{
+    // effects: if ret_val is an exception, reports and counts it
+    if (!jerry_value_has_error_flag(ret_val)) {
+        return;
+    }
+    uncaught_errors++;
+
+    ZJS_SCOPE(scope);
+    jerry_value_t error = ret_val;
+    jerry_value_clear_error_flag(&error);
+    char *msg = zjs_scope_string(&scope,
+                                 zjs_scope_add(&scope,
+                                               jerry_value_to_string(error)),
+                                 128);
+    PRINT("Uncaught exception in callback: %s\n", msg ? msg : "(unknown)");
+}
+
+uint32_t zjs_callbacks_uncaught(void)
+{
+    return uncaught_errors;
+}
+
 void zjs_call_callback(int32_t i)
 {
     if (cb_map[i]->type == CALLBACK_TYPE_JS) {
@@ -395,17 +517,19 @@ void zjs_call_callback(int32_t i)
 
             DBG_PRINT("calling callback id %ld with %lu args\n", cb_map[i]->js->id, argc);
             // TODO: Use 'this' in callback module
-            jerry_call_function(cb_map[i]->js->js_func, cb_map[i]->js->this, args, argc);
+            ret_val = jerry_call_function(cb_map[i]->js->js_func, cb_map[i]->js->this, args, argc);
+            check_uncaught(ret_val);
             if (cb_map[i]->js->post) {
                 cb_map[i]->js->post(cb_map[i]->js->handle, &ret_val);
             }
+            jerry_release_value(ret_val);
             if (cb_map[i]->js->once) {
                 zjs_remove_callback(i);
             }
         } else {
             int j;
             uint32_t argc = 0;
-            jerry_value_t ret_val;
+            jerry_value_t ret_val = ZJS_UNDEFINED;
             jerry_value_t* args = NULL;
 
             if (cb_map[i]->js->pre) {
@@ -414,12 +538,16 @@ void zjs_call_callback(int32_t i)
 
             DBG_PRINT("calling callback list id %ld with %lu args\n", cb_map[i]->js->id, argc);
 
+            // post sees the return value of the last listener
             for (j = 0; j < cb_map[i]->js->num_funcs; ++j) {
-                jerry_call_function(cb_map[i]->js->func_list[j], cb_map[i]->js->this, args, argc);
+                jerry_release_value(ret_val);
+                ret_val = jerry_call_function(cb_map[i]->js->func_list[j], cb_map[i]->js->this, args, argc);
+                check_uncaught(ret_val);
             }
             if (cb_map[i]->js->post) {
                 cb_map[i]->js->post(cb_map[i]->js->handle, &ret_val);
             }
+            jerry_release_value(ret_val);
         }
     } else if (cb_map[i]->type == CALLBACK_TYPE_C && cb_map[i]->c->function) {
         DBG_PRINT("calling callback id %ld\n", cb_map[i]->c->id);
@@ -427,13 +555,27 @@ void zjs_call_callback(int32_t i)
     }
 }
 
-void zjs_service_callbacks(void)
+bool zjs_service_callbacks(void)
 {
     int i;
+    bool serviced = false;
     for (i = 0; i < cb_size; i++) {
         if (cb_map[i] && cb_map[i]->signal) {
             cb_map[i]->signal = 0;
             zjs_call_callback(i);
+            serviced = true;
         }
     }
+    return serviced;
+}
+
+bool zjs_callbacks_pending(void)
+{
+    int i;
+    for (i = 0; i < cb_size; i++) {
+        if (cb_map[i] && cb_map[i]->signal) {
+            return true;
+        }
+    }
+    return false;
 }
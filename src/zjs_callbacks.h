@@ -36,10 +36,18 @@ typedef void (*zjs_post_callback_func)(void* handle, jerry_value_t* ret_val);
 typedef void (*zjs_c_callback_func)(void* handle);
 
 /*
- * Initialize the callback module
+ * Initialize the callback module; this happens on its own when the first
+ * callback is added, so calling it up front is optional
  */
 void zjs_init_callbacks(void);
 
+/*
+ * Remove every callback, releasing the JS values they hold, and free the
+ * callback map; call before jerry_cleanup(). Adding a callback afterwards
+ * starts a new map.
+ */
+void zjs_callbacks_cleanup(void);
+
 /*
  * Get the number of callback functions registered to this ID
  *
@@ -183,7 +191,23 @@ void zjs_call_callback(int32_t i);
 /*
  * Service the callback module. Any callback's that have been signaled will
  * be serviced and the signal flag will be unset.
+ *
+ * @return              True if any callback was called
+ */
+bool zjs_service_callbacks(void);
+/*
+ * Check for signaled callbacks that have not been serviced yet
+ *
+ * @return              True if zjs_service_callbacks() has work to do
+ */
+bool zjs_callbacks_pending(void);
+
+/*
+ * Count the exceptions JS callbacks have thrown that nothing caught; each
+ * one is also printed when it happens
+ *
+ * @return              Number of uncaught exceptions so far
  */
-void zjs_service_callbacks(void);
+uint32_t zjs_callbacks_uncaught(void);
 
 #endif /* SRC_ZJS_CALLBACKS_H_ */
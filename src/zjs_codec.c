@@ -0,0 +1,320 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include <string.h>
+
+#include "zjs_codec.h"
+
+#define X 0xff  // not a digit
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static const char base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// digit values for the 7-bit characters; anything higher is never a digit
+static const uint8_t hex_values[128] = {
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  X,  X,  X,  X,  X,  X,
+     X, 10, 11, 12, 13, 14, 15,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X, 10, 11, 12, 13, 14, 15,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+};
+
+// accepts the URL safe '-' and '_' as well as '+' and '/'
+static const uint8_t base64_values[128] = {
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X,
+     X,  X,  X,  X,  X,  X,  X,  X,  X,  X,  X, 62,  X, 62,  X, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61,  X,  X,  X,  X,  X,  X,
+     X,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,  X,  X,  X,  X, 63,
+     X, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,  X,  X,  X,  X,  X,
+};
+
+static const struct {
+    const char *name;
+    zjs_encoding_t encoding;
+} encoding_names[] = {
+    { "utf8", ZJS_ENCODING_UTF8 },
+    { "utf-8", ZJS_ENCODING_UTF8 },
+    { "ascii", ZJS_ENCODING_ASCII },
+    { "hex", ZJS_ENCODING_HEX },
+    { "base64", ZJS_ENCODING_BASE64 },
+};
+
+// U+FFFD, written in place of bytes that aren't valid UTF-8
+static const char replacement[] = "\xef\xbf\xbd";
+
+zjs_encoding_t zjs_codec_lookup(const char *name)
+{
+    int count = sizeof(encoding_names) / sizeof(encoding_names[0]);
+    for (int i = 0; i < count; i++) {
+        if (!strcmp(name, encoding_names[i].name))
+            return encoding_names[i].encoding;
+    }
+    return ZJS_ENCODING_INVALID;
+}
+
+uint32_t zjs_codec_encoded_max(zjs_encoding_t encoding, uint32_t len)
+{
+    switch (encoding) {
+    case ZJS_ENCODING_HEX:
+        return len * 2;
+    case ZJS_ENCODING_BASE64:
+        return (len + 2) / 3 * 4;
+    case ZJS_ENCODING_UTF8:
+        // a stray byte becomes a three byte replacement character
+        return len * 3;
+    default:
+        return len;
+    }
+}
+
+static uint32_t utf8_sequence(const uint8_t *src, uint32_t len,
+                              uint32_t *code)
+{
+    // effects: decodes the UTF-8 character at the start of src into code and
+    //            returns its length, or returns 0 if it's malformed
+    uint8_t lead = src[0];
+    uint32_t size;
+    uint32_t min;
+    if (lead < 0x80) {
+        *code = lead;
+        return 1;
+    } else if (lead >= 0xc2 && lead <= 0xdf) {
+        size = 2;
+        min = 0x80;
+        *code = lead & 0x1f;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        size = 3;
+        min = 0x800;
+        *code = lead & 0x0f;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        size = 4;
+        min = 0x10000;
+        *code = lead & 0x07;
+    } else {
+        return 0;
+    }
+
+    if (size > len)
+        return 0;
+    for (uint32_t i = 1; i < size; i++) {
+        if ((src[i] & 0xc0) != 0x80)
+            return 0;
+        *code = (*code << 6) | (src[i] & 0x3f);
+    }
+    // reject overlong forms, surrogates and anything past U+10FFFF
+    if (*code < min || (*code >= 0xd800 && *code <= 0xdfff) ||
+        *code > 0x10ffff)
+        return 0;
+    return size;
+}
+
+static char *put_unit(char *dst, uint32_t unit)
+{
+    // effects: writes a UTF-16 code unit as three bytes of CESU-8
+    dst[0] = 0xe0 | (unit >> 12);
+    dst[1] = 0x80 | ((unit >> 6) & 0x3f);
+    dst[2] = 0x80 | (unit & 0x3f);
+    return dst + 3;
+}
+
+uint32_t zjs_codec_encode(zjs_encoding_t encoding, const uint8_t *src,
+                          uint32_t len, char *dst)
+{
+    char *out = dst;
+    uint32_t i = 0;
+
+    switch (encoding) {
+    case ZJS_ENCODING_HEX:
+        for (; i < len; i++) {
+            *out++ = hex_digits[src[i] >> 4];
+            *out++ = hex_digits[src[i] & 0xf];
+        }
+        break;
+
+    case ZJS_ENCODING_BASE64:
+        for (; i + 3 <= len; i += 3) {
+            uint32_t bits = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+            *out++ = base64_digits[bits >> 18];
+            *out++ = base64_digits[(bits >> 12) & 0x3f];
+            *out++ = base64_digits[(bits >> 6) & 0x3f];
+            *out++ = base64_digits[bits & 0x3f];
+        }
+        if (i < len) {
+            uint32_t bits = src[i] << 16;
+            if (i + 1 < len)
+                bits |= src[i + 1] << 8;
+            *out++ = base64_digits[bits >> 18];
+            *out++ = base64_digits[(bits >> 12) & 0x3f];
+            *out++ = i + 1 < len ? base64_digits[(bits >> 6) & 0x3f] : '=';
+            *out++ = '=';
+        }
+        break;
+
+    case ZJS_ENCODING_ASCII:
+        for (; i < len; i++) {
+            *out++ = src[i] & 0x7f;
+        }
+        break;
+
+    case ZJS_ENCODING_UTF8:
+        while (i < len) {
+            // copy runs of plain ASCII without decoding them
+            if (src[i] < 0x80) {
+                *out++ = src[i++];
+                continue;
+            }
+            uint32_t code;
+            uint32_t size = utf8_sequence(src + i, len - i, &code);
+            if (!size) {
+                memcpy(out, replacement, 3);
+                out += 3;
+                i++;
+            } else if (size < 4) {
+                memcpy(out, src + i, size);
+                out += size;
+                i += size;
+            } else {
+                // CESU-8 stores characters past U+FFFF as a surrogate pair
+                code -= 0x10000;
+                out = put_unit(out, 0xd800 | (code >> 10));
+                out = put_unit(out, 0xdc00 | (code & 0x3ff));
+                i += size;
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+    return out - dst;
+}
+
+static uint32_t cesu8_unit(const uint8_t *src, uint32_t len, uint32_t *unit)
+{
+    // effects: decodes the UTF-16 code unit at the start of src and returns
+    //            the number of bytes it takes, at least one
+    uint8_t lead = src[0];
+    if (lead >= 0xe0 && len >= 3) {
+        *unit = ((lead & 0x0f) << 12) | ((src[1] & 0x3f) << 6) |
+                (src[2] & 0x3f);
+        return 3;
+    }
+    if (lead >= 0xc0 && len >= 2) {
+        *unit = ((lead & 0x1f) << 6) | (src[1] & 0x3f);
+        return 2;
+    }
+    *unit = lead;
+    return 1;
+}
+
+uint32_t zjs_codec_decode(zjs_encoding_t encoding, const char *src,
+                          uint32_t len, uint8_t *dst, uint32_t max)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    switch (encoding) {
+    case ZJS_ENCODING_HEX:
+        for (; i + 2 <= len && count < max; i += 2) {
+            uint8_t high = in[i] < 128 ? hex_values[in[i]] : X;
+            uint8_t low = in[i + 1] < 128 ? hex_values[in[i + 1]] : X;
+            if (high == X || low == X)
+                break;
+            if (dst)
+                dst[count] = (high << 4) | low;
+            count++;
+        }
+        break;
+
+    case ZJS_ENCODING_BASE64: {
+        uint32_t bits = 0;
+        int nbits = 0;
+        for (; i < len && count < max; i++) {
+            if (in[i] == '=')
+                break;
+            // skip whitespace and anything else that isn't a digit
+            uint8_t value = in[i] < 128 ? base64_values[in[i]] : X;
+            if (value == X)
+                continue;
+            bits = (bits << 6) | value;
+            nbits += 6;
+            if (nbits >= 8) {
+                nbits -= 8;
+                if (dst)
+                    dst[count] = bits >> nbits;
+                count++;
+            }
+        }
+        break;
+    }
+
+    case ZJS_ENCODING_ASCII:
+        // each character becomes its low byte, as node.js does
+        while (i < len && count < max) {
+            uint32_t unit;
+            i += cesu8_unit(in + i, len - i, &unit);
+            if (dst)
+                dst[count] = unit & 0xff;
+            count++;
+        }
+        break;
+
+    case ZJS_ENCODING_UTF8:
+        while (i < len) {
+            uint32_t size = 1;
+            uint32_t unit;
+            if (in[i] >= 0xe0)
+                cesu8_unit(in + i, len - i, &unit);
+            else
+                unit = 0;
+
+            if (unit >= 0xd800 && unit <= 0xdbff && i + 6 <= len) {
+                // join a surrogate pair back into one four byte character
+                uint32_t low;
+                cesu8_unit(in + i + 3, len - i - 3, &low);
+                if (low >= 0xdc00 && low <= 0xdfff) {
+                    if (count + 4 > max)
+                        break;
+                    uint32_t code = 0x10000 + ((unit & 0x3ff) << 10) +
+                                    (low & 0x3ff);
+                    if (dst) {
+                        dst[count] = 0xf0 | (code >> 18);
+                        dst[count + 1] = 0x80 | ((code >> 12) & 0x3f);
+                        dst[count + 2] = 0x80 | ((code >> 6) & 0x3f);
+                        dst[count + 3] = 0x80 | (code & 0x3f);
+                    }
+                    count += 4;
+                    i += 6;
+                    continue;
+                }
+            }
+
+            // copy the rest a whole character at a time
+            if (in[i] >= 0xe0)
+                size = 3;
+            else if (in[i] >= 0xc0)
+                size = 2;
+            if (size > len - i)
+                size = len - i;
+            if (count + size > max)
+                break;
+            if (dst)
+                memcpy(dst + count, in + i, size);
+            count += size;
+            i += size;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return count;
+}
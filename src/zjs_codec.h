@@ -0,0 +1,42 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_codec_h__
+#define __zjs_codec_h__
+
+#include <stdint.h>
+
+/*
+ * Conversions between binary data and the text encodings Buffer supports.
+ * Text is in the engine's internal string format (CESU-8), so it can be
+ * passed straight to and from jerry strings. Each call makes one pass over
+ * its input and writes directly to the destination given.
+ */
+
+typedef enum zjs_encoding {
+    ZJS_ENCODING_UTF8,
+    ZJS_ENCODING_ASCII,
+    ZJS_ENCODING_HEX,
+    ZJS_ENCODING_BASE64,
+    ZJS_ENCODING_INVALID
+} zjs_encoding_t;
+
+// effects: returns the encoding named name, or ZJS_ENCODING_INVALID
+zjs_encoding_t zjs_codec_lookup(const char *name);
+
+// effects: returns the most text bytes encoding len bytes can produce
+uint32_t zjs_codec_encoded_max(zjs_encoding_t encoding, uint32_t len);
+
+// requires: dst has room for zjs_codec_encoded_max(encoding, len) bytes
+//  effects: encodes len bytes from src as text in dst, and returns the number
+//             of text bytes written; no terminator is added
+uint32_t zjs_codec_encode(zjs_encoding_t encoding, const uint8_t *src,
+                          uint32_t len, char *dst);
+
+// effects: decodes len bytes of text from src into at most max bytes at dst,
+//            stopping at the first malformed hex pair or base64 padding, and
+//            returns the number of bytes written; if dst is NULL, only counts
+//            them
+uint32_t zjs_codec_decode(zjs_encoding_t encoding, const char *src,
+                          uint32_t len, uint8_t *dst, uint32_t max);
+
+#endif  // __zjs_codec_h__
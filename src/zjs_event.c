@@ -1,9 +1,11 @@
+#define ZJS_MEM_MODULE ZJS_MEM_EVENTS
+
 #include "zjs_event.h"
 #include "zjs_callbacks.h"
+#include "zjs_scope.h"
 
 #define ZJS_MAX_EVENT_NAME_SIZE     24
 #define DEFAULT_MAX_LISTENERS       10
-#define HIDDEN_PROP(n) "\377" n
 
 struct event {
     int num_events;
@@ -49,9 +51,11 @@ void post_event(void* h, jerry_value_t* ret_val)
 
 void zjs_add_event_listener(jerry_value_t obj, const char* event, jerry_value_t listener)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(obj, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(obj, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return;
@@ -62,21 +66,24 @@ void zjs_add_event_listener(jerry_value_t obj, const char* event, jerry_value_t
     }
 
     // Event object to hold callback ID and eventually listener arguments
-    jerry_value_t event_obj = zjs_get_property(ev->map, event);
+    jerry_value_t event_obj =
+        zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
-        event_obj = jerry_create_object();
+        event_obj = zjs_scope_add(&scope, jerry_create_object());
     }
 
     int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
+    jerry_value_t id_prop =
+        zjs_scope_add(&scope, zjs_get_property_id(event_obj,
+                                                  ZJS_PROP_CALLBACK_ID));
     if (jerry_value_is_number(id_prop)) {
         // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+        zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     }
     callback_id = zjs_add_callback_list(listener, obj, ev, pre_event, post_event, callback_id);
 
     // Add callback ID to event object
-    zjs_obj_add_number(event_obj, callback_id, "callback_id");
+    zjs_obj_add_number_id(event_obj, callback_id, ZJS_PROP_CALLBACK_ID);
     // Add event object to master event listener
     zjs_set_property(ev->map, event, event_obj);
 
@@ -90,6 +97,7 @@ static jerry_value_t add_listener(const jerry_value_t function_obj,
                                   const jerry_value_t argv[],
                                   const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     if (!jerry_value_is_string(argv[0])) {
         DBG_PRINT("first parameter must be event string\n");
         return ZJS_UNDEFINED;
@@ -98,18 +106,11 @@ static jerry_value_t add_listener(const jerry_value_t function_obj,
         DBG_PRINT("second parameter must be a listener function\n");
         return ZJS_UNDEFINED;
     }
-    int sz = jerry_get_string_size(argv[0]);
-    if (sz > ZJS_MAX_EVENT_NAME_SIZE) {
+    char *name = zjs_scope_string(&scope, argv[0], ZJS_MAX_EVENT_NAME_SIZE);
+    if (!name) {
         DBG_PRINT("event name is too long\n");
         return ZJS_UNDEFINED;
     }
-    char name[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)name, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
-        return ZJS_UNDEFINED;
-    }
-    name[len] = '\0';
 
     zjs_add_event_listener(this, name, argv[1]);
 
@@ -121,18 +122,17 @@ static jerry_value_t emit_event(const jerry_value_t function_obj,
                                 const jerry_value_t argv[],
                                 const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     if (!jerry_value_is_string(argv[0])) {
         DBG_PRINT("parameter is not a string\n");
         return ZJS_UNDEFINED;
     }
-    int sz = jerry_get_string_size(argv[0]);
-    char event[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)event, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
+    char *event = zjs_scope_string(&scope, argv[0],
+                                   ZJS_MAX_EVENT_NAME_SIZE);
+    if (!event) {
+        DBG_PRINT("event name is too long\n");
         return ZJS_UNDEFINED;
     }
-    event[len] = '\0';
 
     return jerry_create_boolean(zjs_trigger_event(this,
                                                   event,
@@ -147,9 +147,11 @@ static jerry_value_t remove_listener(const jerry_value_t function_obj,
                                      const jerry_value_t argv[],
                                      const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -162,27 +164,28 @@ static jerry_value_t remove_listener(const jerry_value_t function_obj,
         DBG_PRINT("event listener must be second parameter\n");
         return ZJS_UNDEFINED;
     }
-    int sz = jerry_get_string_size(argv[0]);
-    char event[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)event, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
+    char *event = zjs_scope_string(&scope, argv[0],
+                                   ZJS_MAX_EVENT_NAME_SIZE);
+    if (!event) {
+        DBG_PRINT("event name is too long\n");
         return ZJS_UNDEFINED;
     }
-    event[len] = '\0';
 
     // Event object to hold callback ID and eventually listener arguments
-    jerry_value_t event_obj = zjs_get_property(ev->map, event);
+    jerry_value_t event_obj =
+        zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         DBG_PRINT("event object not found for '%s'\n", event);
         return ZJS_UNDEFINED;
     }
 
     int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
+    jerry_value_t id_prop =
+        zjs_scope_add(&scope, zjs_get_property_id(event_obj,
+                                                  ZJS_PROP_CALLBACK_ID));
     if (jerry_value_is_number(id_prop)) {
         // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+        zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     } else {
         DBG_PRINT("callback_id not found for '%s'\n", event);
         return ZJS_UNDEFINED;
@@ -198,9 +201,11 @@ static jerry_value_t remove_all_listeners(const jerry_value_t function_obj,
                                           const jerry_value_t argv[],
                                           const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -209,27 +214,28 @@ static jerry_value_t remove_all_listeners(const jerry_value_t function_obj,
         DBG_PRINT("event name must be first parameter\n");
         return ZJS_UNDEFINED;
     }
-    int sz = jerry_get_string_size(argv[0]);
-    char event[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)event, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
+    char *event = zjs_scope_string(&scope, argv[0],
+                                   ZJS_MAX_EVENT_NAME_SIZE);
+    if (!event) {
+        DBG_PRINT("event name is too long\n");
         return ZJS_UNDEFINED;
     }
-    event[len] = '\0';
 
     // Event object to hold callback ID and eventually listener arguments
-    jerry_value_t event_obj = zjs_get_property(ev->map, event);
+    jerry_value_t event_obj =
+        zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         DBG_PRINT("event object not found for '%s'\n", event);
         return ZJS_UNDEFINED;
     }
 
     int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
+    jerry_value_t id_prop =
+        zjs_scope_add(&scope, zjs_get_property_id(event_obj,
+                                                  ZJS_PROP_CALLBACK_ID));
     if (jerry_value_is_number(id_prop)) {
         // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+        zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     } else {
         DBG_PRINT("callback_id not found for '%s'\n", event);
         return ZJS_UNDEFINED;
@@ -261,10 +267,12 @@ static jerry_value_t get_event_names(const jerry_value_t function_obj,
                                      const jerry_value_t argv[],
                                      const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
     struct event_names names;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -282,9 +290,11 @@ static jerry_value_t get_max_listeners(const jerry_value_t function_obj,
                                        const jerry_value_t argv[],
                                        const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -297,9 +307,11 @@ static jerry_value_t set_max_listeners(const jerry_value_t function_obj,
                                        const jerry_value_t argv[],
                                        const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -330,9 +342,11 @@ static jerry_value_t get_listener_count(const jerry_value_t function_obj,
                                         const jerry_value_t argv[],
                                         const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return zjs_error("native handle not found");
@@ -341,27 +355,28 @@ static jerry_value_t get_listener_count(const jerry_value_t function_obj,
         DBG_PRINT("event name must be first parameter\n");
         return zjs_error("event name must be first parameter");
     }
-    int sz = jerry_get_string_size(argv[0]);
-    char event[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)event, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
+    char *event = zjs_scope_string(&scope, argv[0],
+                                   ZJS_MAX_EVENT_NAME_SIZE);
+    if (!event) {
+        DBG_PRINT("event name is too long\n");
         return zjs_error("string size mismatch");
     }
-    event[len] = '\0';
 
     // Event object to hold callback ID and eventually listener arguments
-    jerry_value_t event_obj = zjs_get_property(ev->map, event);
+    jerry_value_t event_obj =
+        zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         DBG_PRINT("event object not found for '%s'\n", event);
         return jerry_create_number(0);
     }
 
     int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
+    jerry_value_t id_prop =
+        zjs_scope_add(&scope, zjs_get_property_id(event_obj,
+                                                  ZJS_PROP_CALLBACK_ID));
     if (jerry_value_is_number(id_prop)) {
         // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+        zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     } else {
         DBG_PRINT("callback_id not found for '%s'\n", event);
         return jerry_create_number(0);
@@ -375,9 +390,11 @@ static jerry_value_t get_listeners(const jerry_value_t function_obj,
                                    const jerry_value_t argv[],
                                    const jerry_length_t argc)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(this, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         DBG_PRINT("native handle not found\n");
         return ZJS_UNDEFINED;
@@ -386,27 +403,28 @@ static jerry_value_t get_listeners(const jerry_value_t function_obj,
         DBG_PRINT("event name must be first parameter\n");
         return ZJS_UNDEFINED;
     }
-    int sz = jerry_get_string_size(argv[0]);
-    char event[sz];
-    int len = jerry_string_to_char_buffer(argv[0], (jerry_char_t *)event, sz);
-    if (len != sz) {
-        DBG_PRINT("size mismatch\n");
+    char *event = zjs_scope_string(&scope, argv[0],
+                                   ZJS_MAX_EVENT_NAME_SIZE);
+    if (!event) {
+        DBG_PRINT("event name is too long\n");
         return ZJS_UNDEFINED;
     }
-    event[len] = '\0';
 
     // Event object to hold callback ID and eventually listener arguments
-    jerry_value_t event_obj = zjs_get_property(ev->map, event);
+    jerry_value_t event_obj =
+        zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         DBG_PRINT("event object not found for '%s'\n", event);
         return ZJS_UNDEFINED;
     }
 
     int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
+    jerry_value_t id_prop =
+        zjs_scope_add(&scope, zjs_get_property_id(event_obj,
+                                                  ZJS_PROP_CALLBACK_ID));
     if (jerry_value_is_number(id_prop)) {
         // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+        zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     } else {
         DBG_PRINT("callback_id not found for '%s'\n", event);
         return ZJS_UNDEFINED;
@@ -428,6 +446,7 @@ bool zjs_trigger_event(jerry_value_t obj,
                        zjs_post_event post,
                        void* h)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
     struct event_trigger* trigger = zjs_malloc(sizeof(struct event_trigger));
     if (!trigger) {
@@ -438,7 +457,8 @@ bool zjs_trigger_event(jerry_value_t obj,
     int32_t callback_id = -1;
     jerry_value_t event_obj;
 
-    jerry_value_t event_emitter = zjs_get_property(obj, HIDDEN_PROP("event"));
+    jerry_value_t event_emitter =
+        zjs_scope_add(&scope, zjs_get_property_id(obj, ZJS_PROP_EVENT));
     if (!jerry_get_object_native_handle(event_emitter, (uintptr_t*)&ev)) {
         zjs_free(trigger);
         DBG_PRINT("native handle not found\n");
@@ -457,14 +477,14 @@ bool zjs_trigger_event(jerry_value_t obj,
     }
     trigger->argc = argc;
 
-    event_obj = zjs_get_property(ev->map, event);
+    event_obj = zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         zjs_free(trigger);
         DBG_PRINT("event object not found\n");
         return false;
     }
 
-    if (!zjs_obj_get_int32(event_obj, "callback_id", &callback_id)) {
+    if (!zjs_obj_get_int32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id)) {
         zjs_free(trigger);
         DBG_PRINT("[event] zjs_trigger_event(): Error, callback_id not found\n");
         return false;
@@ -490,6 +510,7 @@ bool zjs_trigger_event_now(jerry_value_t obj,
                            zjs_post_event post,
                            void* h)
 {
+    ZJS_SCOPE(scope);
     struct event* ev;
     struct event_trigger* trigger = zjs_malloc(sizeof(struct event_trigger));
     if (!trigger) {
@@ -518,14 +539,14 @@ bool zjs_trigger_event_now(jerry_value_t obj,
     }
     trigger->argc = argc;
 
-    event_obj = zjs_get_property(ev->map, event);
+    event_obj = zjs_scope_add(&scope, zjs_get_property(ev->map, event));
     if (!jerry_value_is_object(event_obj)) {
         zjs_free(trigger);
         DBG_PRINT("event object not found\n");
         return false;
     }
 
-    zjs_obj_get_uint32(event_obj, "callback_id", &callback_id);
+    zjs_obj_get_uint32_id(event_obj, ZJS_PROP_CALLBACK_ID, &callback_id);
     if (callback_id == -1) {
         zjs_free(trigger);
         DBG_PRINT("callback_id not found\n");
@@ -551,9 +572,22 @@ static void destroy_event(const uintptr_t pointer)
     }
 }
 
+static const zjs_native_func_t event_funcs[] = {
+    { add_listener, "on" },
+    { add_listener, "addListener" },
+    { emit_event, "emit" },
+    { remove_listener, "removeListener" },
+    { remove_all_listeners, "removeAllListeners" },
+    { get_event_names, "eventNames" },
+    { get_max_listeners, "getMaxListeners" },
+    { get_listener_count, "listenerCount" },
+    { get_listeners, "listeners" },
+    { set_max_listeners, "setMaxListeners" },
+    { NULL, NULL }
+};
+
 void zjs_make_event(jerry_value_t obj)
 {
-    jerry_value_t event_obj = jerry_create_object();
     struct event* ev = zjs_malloc(sizeof(struct event));
     if (!ev) {
         DBG_PRINT("could not allocate event handle, out of memory\n");
@@ -564,20 +598,13 @@ void zjs_make_event(jerry_value_t obj)
     ev->num_events = 0;
     ev->map = jerry_create_object();
 
-    zjs_obj_add_function(obj, add_listener, "on");
-    zjs_obj_add_function(obj, add_listener, "addListener");
-    zjs_obj_add_function(obj, emit_event, "emit");
-    zjs_obj_add_function(obj, remove_listener, "removeListener");
-    zjs_obj_add_function(obj, remove_all_listeners, "removeAllListeners");
-    zjs_obj_add_function(obj, get_event_names, "eventNames");
-    zjs_obj_add_function(obj, get_max_listeners, "getMaxListeners");
-    zjs_obj_add_function(obj, get_listener_count, "listenerCount");
-    zjs_obj_add_function(obj, get_listeners, "listeners");
-    zjs_obj_add_function(obj, set_max_listeners, "setMaxListeners");
+    zjs_set_class(obj, ZJS_CLASS_EVENT_EMITTER, event_funcs);
 
+    jerry_value_t event_obj = jerry_create_object();
     jerry_set_object_native_handle(event_obj, (uintptr_t)ev, destroy_event);
 
-    zjs_obj_add_object(obj, event_obj, HIDDEN_PROP("event"));
+    zjs_obj_add_object_id(obj, event_obj, ZJS_PROP_EVENT);
+    jerry_release_value(event_obj);
 }
 
 static jerry_value_t event_constructor(const jerry_value_t function_obj,
@@ -13,7 +13,8 @@ typedef void (*zjs_post_event)(void* handle);
 /*
  * Turn an object into an event object. After this call the object will have
  * all the event functions like addListener(), on(), etc. This object can also
- * be used to trigger events in C.
+ * be used to trigger events in C. The functions come from a shared prototype,
+ * so obj must be a plain object without a prototype of its own.
  *
  * @param obj           Object to turn into an event object
  */
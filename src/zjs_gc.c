@@ -0,0 +1,110 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef ZJS_LINUX_BUILD
+#include "zjs_zephyr_time.h"
+#else
+#include "zjs_linux_time.h"
+#endif
+
+#include "jerry-api.h"
+
+#include "zjs_common.h"
+#include "zjs_gc.h"
+
+#define MAX_TRIM_FUNCS  8
+
+static zjs_trim_func trim_funcs[MAX_TRIM_FUNCS];
+static int trim_count = 0;
+
+static bool gc_enabled = false;
+static bool reclaiming = false;
+
+static uint32_t reclaims = 0;
+static uint32_t rescues = 0;
+static uint32_t low_water = 0;
+
+static const uint32_t idle_threshold = ZJS_GC_IDLE_MS;
+// the script itself leaves garbage behind before the loop starts
+static bool idle_dirty = true;
+static uint32_t idle_runs = 0;
+static uint32_t idle_us_total = 0;
+static uint32_t idle_us_max = 0;
+
+void zjs_gc_init(void)
+{
+    gc_enabled = true;
+}
+
+void zjs_gc_register_trim(zjs_trim_func trim)
+{
+    if (trim_count == MAX_TRIM_FUNCS) {
+        DBG_PRINT("no room for trim function\n");
+        return;
+    }
+    trim_funcs[trim_count++] = trim;
+}
+
+bool zjs_gc_reclaim(void)
+{
+    // GC runs native free callbacks, which free memory and may even allocate
+    //   again, so don't let that start another pass
+    if (!gc_enabled || reclaiming) {
+        return false;
+    }
+    reclaiming = true;
+
+    jerry_gc();
+    for (int i = 0; i < trim_count; i++) {
+        trim_funcs[i]();
+    }
+    reclaims++;
+
+    reclaiming = false;
+    return true;
+}
+
+void zjs_gc_activity(void)
+{
+    idle_dirty = true;
+}
+
+void zjs_gc_idle(uint32_t idle_ms)
+{
+    if (!idle_dirty || !idle_threshold || idle_ms < idle_threshold) {
+        return;
+    }
+
+    uint32_t start = zjs_port_get_us();
+    if (!zjs_gc_reclaim()) {
+        return;
+    }
+    uint32_t elapsed = zjs_port_get_us() - start;
+
+    idle_dirty = false;
+    idle_runs++;
+    idle_us_total += elapsed;
+    if (idle_us_max < elapsed) {
+        idle_us_max = elapsed;
+    }
+    DBG_PRINT("idle reclaim took %luus\n", (unsigned long)elapsed);
+}
+
+void zjs_gc_count_rescue(void)
+{
+    rescues++;
+}
+
+void zjs_gc_count_low_water(void)
+{
+    low_water++;
+}
+
+void zjs_gc_print_stats(void)
+{
+    PRINT("GC reclaims: %lu, allocations rescued: %lu, low-water hits: %lu\n",
+          (unsigned long)reclaims, (unsigned long)rescues,
+          (unsigned long)low_water);
+    PRINT("Idle reclaims: %lu, total %luus, max %luus (threshold %lums)\n",
+          (unsigned long)idle_runs, (unsigned long)idle_us_total,
+          (unsigned long)idle_us_max, (unsigned long)idle_threshold);
+}
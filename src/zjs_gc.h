@@ -0,0 +1,56 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_gc_h__
+#define __zjs_gc_h__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Memory pressure handling. When an allocation fails, or the allocator
+ * reports it is running low, a JerryScript GC pass is run so dead objects
+ * give back their native memory (e.g. Buffer data), then every registered
+ * trim function is called to shrink native caches.
+ *
+ * The same reclaim is also run from the main loop when it is idle, so most
+ * collections happen between callbacks rather than in the middle of one.
+ */
+
+// minimum time until the next timer for an idle reclaim to run, in ms;
+//   0 disables idle reclaims; set with GC_IDLE_MS= on the make command line
+#ifndef ZJS_GC_IDLE_MS
+#define ZJS_GC_IDLE_MS 50
+#endif
+
+// trim functions release whatever memory their module can do without
+typedef void (*zjs_trim_func)(void);
+
+// effects: enables reclaiming, call once the JerryScript engine is up
+void zjs_gc_init(void);
+
+// effects: adds trim to the functions called by zjs_gc_reclaim
+void zjs_gc_register_trim(zjs_trim_func trim);
+
+// effects: runs GC and the trim functions; returns false without doing
+//            anything if a reclaim is already in progress or GC isn't
+//            enabled yet
+bool zjs_gc_reclaim(void);
+
+// effects: notes that JS code ran, so there may be new garbage
+void zjs_gc_activity(void);
+
+// requires: call from the main loop when no callbacks are pending
+//  effects: runs a reclaim if JS has run since the last one and idle_ms,
+//             the time until the next timer, is at least the idle threshold
+void zjs_gc_idle(uint32_t idle_ms);
+
+// effects: records that an allocation only succeeded because of a reclaim
+void zjs_gc_count_rescue(void);
+
+// effects: records a crossing of the allocator's low-water mark
+void zjs_gc_count_low_water(void);
+
+// effects: prints reclaim statistics to the console
+void zjs_gc_print_stats(void);
+
+#endif  // __zjs_gc_h__
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_GPIO
 #ifdef BUILD_MODULE_GPIO
 // Zephyr includes
 #include <zephyr.h>
@@ -32,15 +33,19 @@ static const char *ZJS_PULL_DOWN = "down";
 
 static struct device *zjs_gpio_dev[GPIO_DEV_COUNT];
 
-void (*zjs_gpio_convert_pin)(uint32_t orig, int *dev, int *pin) =
-    zjs_default_convert_pin;
+const zjs_pin_map_t *zjs_gpio_pins = NULL;
 
-// Handle for GPIO input pins, passed around between ISR/C callbacks
+// Handle for GPIO pins, stored as the pin object's native handle so methods
+//   don't have to look up and convert the pin again; also passed around
+//   between ISR/C callbacks for input pins
 struct gpio_handle {
     struct gpio_callback callback;  // Callback structure for zephyr
-    uint32_t pin;                   // Pin associated with this handle
+    struct device *port;            // GPIO device the pin is on
+    uint32_t pin;                   // Pin number on that device
     uint32_t value;                 // Value of the pin
-    int32_t callbackId;             // ID for the C callback
+    int32_t callbackId;             // ID for the C callback, -1 if none
+    bool active_low;
+    bool closed;
     jerry_value_t pin_obj;          // Pin object returned from open()
     jerry_value_t onchange_func;    // Function registered to onChange
     jerry_value_t* open_ret_args;
@@ -50,13 +55,14 @@ struct gpio_handle {
 static void gpio_c_callback(void* h)
 {
     struct gpio_handle *handle = (struct gpio_handle*)h;
-    jerry_value_t onchange_func = zjs_get_property(handle->pin_obj, "onchange");
+    jerry_value_t onchange_func = zjs_get_property_id(handle->pin_obj,
+                                                      ZJS_PROP_ONCHANGE);
 
     // If pin.onChange exists, call it
     if (jerry_value_is_function(onchange_func)) {
         jerry_value_t event = jerry_create_object();
         // Put the boolean GPIO trigger value in the object
-        zjs_obj_add_boolean(event, handle->value, "value");
+        zjs_obj_add_boolean_id(event, handle->value, ZJS_PROP_VALUE);
 
         // Only aquire once, once we have it just keep using it.
         // It will be released in close()
@@ -65,8 +71,10 @@ static void gpio_c_callback(void* h)
         }
 
         // Call the JS callback
-        jerry_call_function(handle->onchange_func, ZJS_UNDEFINED, &event, 1);
+        jerry_value_t rval = jerry_call_function(handle->onchange_func,
+                                                 ZJS_UNDEFINED, &event, 1);
 
+        jerry_release_value(rval);
         jerry_release_value(event);
     } else {
         DBG_PRINT(("onChange has not been registered\n"));
@@ -92,10 +100,50 @@ static struct gpio_handle* new_gpio_handle(void)
 {
 
     struct gpio_handle* handle = zjs_malloc(sizeof(struct gpio_handle));
-    memset(handle, 0, sizeof(struct gpio_handle));
+    if (handle) {
+        memset(handle, 0, sizeof(struct gpio_handle));
+        handle->callbackId = -1;
+    }
     return handle;
 }
 
+static void close_gpio_handle(struct gpio_handle *handle)
+{
+    // effects: stops watching the pin for changes, if it was an input
+    if (handle->callbackId != -1) {
+        zjs_remove_callback(handle->callbackId);
+        gpio_remove_callback(handle->port, &handle->callback);
+        handle->callbackId = -1;
+    }
+    if (handle->onchange_func) {
+        jerry_release_value(handle->onchange_func);
+        handle->onchange_func = 0;
+    }
+    handle->closed = true;
+}
+
+static void free_gpio_handle(const uintptr_t native)
+{
+    // effects: called when the pin object is garbage collected
+    struct gpio_handle *handle = (struct gpio_handle *)native;
+    if (!handle->closed) {
+        close_gpio_handle(handle);
+    }
+    zjs_free(handle);
+}
+
+static struct gpio_handle *get_gpio_handle(const jerry_value_t obj)
+{
+    // effects: returns the handle for an open pin object, or NULL
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_GPIO_PIN) ||
+        !jerry_get_object_native_handle(obj, &native) || !native) {
+        return NULL;
+    }
+    struct gpio_handle *handle = (struct gpio_handle *)native;
+    return handle->closed ? NULL : handle;
+}
+
 static jerry_value_t zjs_gpio_pin_read(const jerry_value_t function_obj,
                                        const jerry_value_t this,
                                        const jerry_value_t argv[],
@@ -103,26 +151,18 @@ static jerry_value_t zjs_gpio_pin_read(const jerry_value_t function_obj,
 {
     // requires: this is a GPIOPin object from zjs_gpio_open, takes no args
     //  effects: reads a logical value from the pin and returns it in ret_val_p
-    uint32_t pin;
-    zjs_obj_get_uint32(this, "pin", &pin);
-    int devnum, newpin;
-    zjs_gpio_convert_pin(pin, &devnum, &newpin);
-
-    bool activeLow = false;
-    zjs_obj_get_boolean(this, "activeLow", &activeLow);
+    struct gpio_handle *handle = get_gpio_handle(this);
+    if (!handle)
+        return zjs_error("zjs_gpio_pin_read: pin is not open");
 
     uint32_t value;
-    int rval = gpio_pin_read(zjs_gpio_dev[devnum], newpin, &value);
+    int rval = gpio_pin_read(handle->port, handle->pin, &value);
     if (rval) {
-        PRINT("PIN: #%d\n", newpin);
+        PRINT("PIN: #%lu\n", (unsigned long)handle->pin);
         return zjs_error("zjs_gpio_pin_read: reading from GPIO");
     }
 
-    bool logical = false;
-    if ((value && !activeLow) || (!value && activeLow))
-        logical = true;
-
-    return jerry_create_boolean(logical);
+    return jerry_create_boolean(!value != !handle->active_low);
 }
 
 static jerry_value_t zjs_gpio_pin_write(const jerry_value_t function_obj,
@@ -136,22 +176,15 @@ static jerry_value_t zjs_gpio_pin_write(const jerry_value_t function_obj,
     if (argc < 1 || !jerry_value_is_boolean(argv[0]))
         return zjs_error("zjs_gpio_pin_write: invalid argument");
 
-    bool logical = jerry_get_boolean_value(argv[0]);
-
-    uint32_t pin;
-    zjs_obj_get_uint32(this, "pin", &pin);
-    int devnum, newpin;
-    zjs_gpio_convert_pin(pin, &devnum, &newpin);
-
-    bool activeLow = false;
-    zjs_obj_get_boolean(this, "activeLow", &activeLow);
+    struct gpio_handle *handle = get_gpio_handle(this);
+    if (!handle)
+        return zjs_error("zjs_gpio_pin_write: pin is not open");
 
-    uint32_t value = 0;
-    if ((logical && !activeLow) || (!logical && activeLow))
-        value = 1;
-    int rval = gpio_pin_write(zjs_gpio_dev[devnum], newpin, value);
+    bool logical = jerry_get_boolean_value(argv[0]);
+    uint32_t value = logical != handle->active_low;
+    int rval = gpio_pin_write(handle->port, handle->pin, value);
     if (rval) {
-        PRINT("GPIO: #%d!n", newpin);
+        PRINT("GPIO: #%lu\n", (unsigned long)handle->pin);
         return zjs_error("zjs_gpio_pin_write: error writing to GPIO");
     }
 
@@ -163,23 +196,10 @@ static jerry_value_t zjs_gpio_pin_close(const jerry_value_t function_obj,
                                         const jerry_value_t argv[],
                                         const jerry_length_t argc)
 {
-    uintptr_t ptr;
-    if (jerry_get_object_native_handle(this, &ptr)) {
-        struct gpio_handle* handle = (struct gpio_handle*)ptr;
-        if (handle) {
-            zjs_remove_callback(handle->callbackId);
-            if (handle->onchange_func) {
-                jerry_release_value(handle->onchange_func);
-            }
-
-            uint32_t pin;
-            zjs_obj_get_uint32(this, "pin", &pin);
-            int devnum, newpin;
-            zjs_gpio_convert_pin(pin, &devnum, &newpin);
-
-            gpio_remove_callback(zjs_gpio_dev[devnum], &handle->callback);
-            zjs_free(handle);
-        }
+    // the handle itself is freed when the object is collected
+    struct gpio_handle *handle = get_gpio_handle(this);
+    if (handle) {
+        close_gpio_handle(handle);
     }
 
     return ZJS_UNDEFINED;
@@ -196,6 +216,13 @@ static void post_open_promise(void* h)
     }
 }
 
+static const zjs_native_func_t gpio_pin_funcs[] = {
+    { zjs_gpio_pin_read, "read" },
+    { zjs_gpio_pin_write, "write" },
+    { zjs_gpio_pin_close, "close" },
+    { NULL, NULL }
+};
+
 static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
                                    const jerry_value_t this,
                                    const jerry_value_t argv[],
@@ -212,11 +239,11 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
     jerry_value_t data = argv[0];
 
     uint32_t pin;
-    if (!zjs_obj_get_uint32(data, "pin", &pin))
+    if (!zjs_obj_get_uint32_id(data, ZJS_PROP_PIN, &pin))
         return zjs_error("zjs_gpio_open: missing required field");
 
     int devnum, newpin;
-    zjs_gpio_convert_pin(pin, &devnum, &newpin);
+    zjs_pin_convert(zjs_gpio_pins, pin, &devnum, &newpin);
     if (newpin == -1)
         return zjs_error("zjs_gpio_open: invalid pin");
 
@@ -232,7 +259,7 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
     flags |= dirOut ? GPIO_DIR_OUT : GPIO_DIR_IN;
 
     bool activeLow = false;
-    zjs_obj_get_boolean(data, "activeLow", &activeLow);
+    zjs_obj_get_boolean_id(data, ZJS_PROP_ACTIVE_LOW, &activeLow);
     flags |= activeLow ? GPIO_POL_INV : GPIO_POL_NORMAL;
 
     const char *edge = ZJS_EDGE_NONE;
@@ -285,35 +312,37 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
     }
 
     // create the GPIOPin object
-    jerry_value_t pinobj = jerry_create_object();
-    zjs_obj_add_function(pinobj, zjs_gpio_pin_read, "read");
-    zjs_obj_add_function(pinobj, zjs_gpio_pin_write, "write");
-    zjs_obj_add_function(pinobj, zjs_gpio_pin_close, "close");
-    zjs_obj_add_number(pinobj, pin, "pin");
+    jerry_value_t pinobj = zjs_create_instance(ZJS_CLASS_GPIO_PIN,
+                                               gpio_pin_funcs);
+    zjs_obj_add_number_id(pinobj, pin, ZJS_PROP_PIN);
     zjs_obj_add_string(pinobj, dirOut ? ZJS_DIR_OUT : ZJS_DIR_IN, "direction");
-    zjs_obj_add_boolean(pinobj, activeLow, "activeLow");
+    zjs_obj_add_boolean_id(pinobj, activeLow, ZJS_PROP_ACTIVE_LOW);
     zjs_obj_add_string(pinobj, edge, "edge");
     zjs_obj_add_string(pinobj, pull, "pull");
     // TODO: When we implement close, we should release the reference on this
 
-    struct gpio_handle* handle = NULL;
-    if (async || !dirOut)
-        handle = new_gpio_handle();
-
-    // Only need the handle if this pin is an input
+    struct gpio_handle* handle = new_gpio_handle();
+    if (!handle) {
+        jerry_release_value(pinobj);
+        return zjs_error("zjs_gpio_open: could not allocate handle");
+    }
+    handle->port = zjs_gpio_dev[devnum];
+    handle->pin = newpin;
+    handle->active_low = activeLow;
+    handle->pin_obj = async ? jerry_acquire_value(pinobj) : pinobj;
+    jerry_set_object_native_handle(pinobj, (uintptr_t)handle,
+                                   free_gpio_handle);
+
+    // Only need the callbacks if this pin is an input
     if (!dirOut) {
         // Zephyr ISR callback init
         gpio_init_callback(&handle->callback, gpio_zephyr_callback,
                            BIT(newpin));
-        gpio_add_callback(zjs_gpio_dev[devnum], &handle->callback);
-        gpio_pin_enable_callback(zjs_gpio_dev[devnum], newpin);
+        gpio_add_callback(handle->port, &handle->callback);
+        gpio_pin_enable_callback(handle->port, newpin);
 
-        handle->pin = newpin;
-        handle->pin_obj = async ? jerry_acquire_value(pinobj) : pinobj;
         // Register a C callback (will be called after the ISR is called)
         handle->callbackId = zjs_add_c_callback(handle, gpio_c_callback);
-        // Set the native handle so we can free it when close() is called
-        jerry_set_object_native_handle(pinobj, (uintptr_t)handle, NULL);
     }
 
     if (async) {
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_GROVE_LCD
 #ifdef BUILD_MODULE_GROVE_LCD
 #ifndef QEMU_BUILD
 #ifndef ZJS_LINUX_BUILD
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_I2C
 #ifdef BUILD_MODULE_I2C
 #ifndef QEMU_BUILD
 // Zephyr includes
@@ -57,6 +58,19 @@ static void ipm_msg_receive_callback(void *context, uint32_t id, volatile void *
     }
 }
 
+static bool zjs_i2c_get_bus(const jerry_value_t obj, uint8_t *bus)
+{
+    // effects: finds the bus number of an I2C object from zjs_i2c_open; it's
+    //            small enough to be stored as the native handle itself
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_I2C) ||
+        !jerry_get_object_native_handle(obj, &native)) {
+        return false;
+    }
+    *bus = (uint8_t)native;
+    return true;
+}
+
 static jerry_value_t zjs_i2c_read_base(const jerry_value_t this,
                                        const jerry_value_t argv[],
                                        const jerry_length_t argc,
@@ -91,8 +105,10 @@ static jerry_value_t zjs_i2c_read_base(const jerry_value_t this,
         return zjs_error("zjs_i2c_read_base: size should be greater than zero");
     }
 
-    uint32_t bus;
-    zjs_obj_get_uint32(this, "bus", &bus);
+    uint8_t bus;
+    if (!zjs_i2c_get_bus(this, &bus)) {
+        return zjs_error("zjs_i2c_read_base: not an I2C object");
+    }
     uint32_t address = (uint32_t)jerry_get_number_value(argv[0]);
     jerry_value_t buf_obj = zjs_buffer_create(size);
     zjs_buffer_t *buf;
@@ -119,7 +135,7 @@ static jerry_value_t zjs_i2c_read_base(const jerry_value_t this,
         send.type = TYPE_I2C_BURST_READ;
     }
 
-    send.data.i2c.bus = (uint8_t)bus;
+    send.data.i2c.bus = bus;
     send.data.i2c.data = buf->buffer;
     send.data.i2c.address = (uint16_t)address;
     send.data.i2c.register_addr = register_addr;
@@ -199,8 +215,10 @@ static jerry_value_t zjs_i2c_write(const jerry_value_t function_obj,
         register_addr = (uint32_t)jerry_get_number_value(argv[2]);
     }
 
-    uint32_t bus;
-    zjs_obj_get_uint32(this, "bus", &bus);
+    uint8_t bus;
+    if (!zjs_i2c_get_bus(this, &bus)) {
+        return zjs_error("zjs_i2c_write: not an I2C object");
+    }
     zjs_buffer_t *dataBuf = zjs_buffer_find(argv[1]);
 
     if (dataBuf != NULL) {
@@ -220,7 +238,7 @@ static jerry_value_t zjs_i2c_write(const jerry_value_t function_obj,
     zjs_ipm_message_t reply;
 
     send.type = TYPE_I2C_WRITE;
-    send.data.i2c.bus = (uint8_t)bus;
+    send.data.i2c.bus = bus;
     send.data.i2c.data = dataBuf->buffer;
     send.data.i2c.register_addr = register_addr;
     send.data.i2c.address = (uint16_t)address;
@@ -253,6 +271,15 @@ static jerry_value_t zjs_i2c_close(const jerry_value_t function_obj,
     return ZJS_UNDEFINED;
 }
 
+static const zjs_native_func_t i2c_funcs[] = {
+    { zjs_i2c_read, "read" },
+    { zjs_i2c_burst_read, "burstRead" },
+    { zjs_i2c_write, "write" },
+    { zjs_i2c_abort, "abort" },
+    { zjs_i2c_close, "close" },
+    { NULL, NULL }
+};
+
 static jerry_value_t zjs_i2c_open(const jerry_value_t function_obj,
                                   const jerry_value_t this,
                                   const jerry_value_t argv[],
@@ -271,7 +298,7 @@ static jerry_value_t zjs_i2c_open(const jerry_value_t function_obj,
     uint32_t bus;
     uint32_t speed;
 
-    if (!zjs_obj_get_uint32(data, "bus", &bus)) {
+    if (!zjs_obj_get_uint32_id(data, ZJS_PROP_BUS, &bus)) {
         return zjs_error("zjs_i2c_open: missing required field (bus)");
     }
 
@@ -294,13 +321,9 @@ static jerry_value_t zjs_i2c_open(const jerry_value_t function_obj,
     }
 
     // create the I2C object
-    jerry_value_t i2c_obj = jerry_create_object();
-    zjs_obj_add_function(i2c_obj, zjs_i2c_read, "read");
-    zjs_obj_add_function(i2c_obj, zjs_i2c_burst_read, "burstRead");
-    zjs_obj_add_function(i2c_obj, zjs_i2c_write, "write");
-    zjs_obj_add_function(i2c_obj, zjs_i2c_abort, "abort");
-    zjs_obj_add_function(i2c_obj, zjs_i2c_close, "close");
-    zjs_obj_add_number(i2c_obj, bus, "bus");
+    jerry_value_t i2c_obj = zjs_create_instance(ZJS_CLASS_I2C, i2c_funcs);
+    zjs_obj_add_number_id(i2c_obj, bus, ZJS_PROP_BUS);
+    jerry_set_object_native_handle(i2c_obj, (uintptr_t)(uint8_t)bus, NULL);
     zjs_obj_add_number(i2c_obj, speed, "speed");
 
     return i2c_obj;
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_IPM
 #ifndef QEMU_BUILD
 // ipm for ARC communication
 #include <ipm/ipm_quark_se.h>
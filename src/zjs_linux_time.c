@@ -53,3 +53,24 @@ uint8_t zjs_port_timer_test(zjs_port_timer_t* timer, uint32_t ticks)
     return 0;
 }
 
+uint32_t zjs_port_timer_ms_remaining(zjs_port_timer_t* timer)
+{
+    uint32_t elapsed;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    elapsed = (1000 * (now.tv_sec - timer->sec)) + ((now.tv_nsec / 1000000) - timer->milli);
+
+    if (elapsed >= timer->interval) {
+        return 0;
+    }
+    return timer->interval - elapsed;
+}
+
+uint32_t zjs_port_get_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
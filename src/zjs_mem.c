@@ -0,0 +1,298 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include <string.h>
+
+#include "zjs_common.h"
+#include "zjs_gc.h"
+#include "zjs_mem.h"
+#include "zjs_util.h"
+
+#ifdef ZJS_MEM_STATS
+
+static const char *module_names[ZJS_MEM_MODULE_COUNT] = {
+    [ZJS_MEM_CORE] =        "core",
+    [ZJS_MEM_AIO] =         "aio",
+    [ZJS_MEM_BLE] =         "ble",
+    [ZJS_MEM_BUFFER] =      "buffer",
+    [ZJS_MEM_CALLBACKS] =   "callbacks",
+    [ZJS_MEM_EVENTS] =      "events",
+    [ZJS_MEM_GPIO] =        "gpio",
+    [ZJS_MEM_GROVE_LCD] =   "grove_lcd",
+    [ZJS_MEM_I2C] =         "i2c",
+    [ZJS_MEM_IPM] =         "ipm",
+    [ZJS_MEM_PROMISE] =     "promise",
+    [ZJS_MEM_PWM] =         "pwm",
+    [ZJS_MEM_TIMERS] =      "timers",
+};
+
+typedef struct mem_usage {
+    uint32_t used;
+    uint32_t peak;
+    uint32_t quota;
+    // allocations refused for being over quota
+    uint32_t denied;
+    // allocations the underlying allocator couldn't satisfy
+    uint32_t failed;
+    // allocations made, and how many of them are still live
+    uint32_t allocs;
+    uint32_t blocks;
+} mem_usage_t;
+
+// the union keeps the block that follows the header aligned for any type
+typedef union mem_header {
+    struct {
+        uint32_t size;
+        uint8_t module;
+    } h;
+    uint64_t align;
+} mem_header_t;
+
+static mem_usage_t usage[ZJS_MEM_MODULE_COUNT];
+
+// across all modules, unlike the sum of the per module peaks
+static uint32_t total_used = 0;
+static uint32_t total_peak = 0;
+
+#define HEADER_SIZE sizeof(mem_header_t)
+
+static bool over_quota(mem_usage_t *mod, uint32_t size)
+{
+    return mod->quota && mod->used + size > mod->quota;
+}
+
+void zjs_mem_set_quota(zjs_mem_module_t module, uint32_t quota)
+{
+    usage[module].quota = quota;
+}
+
+static int find_module(const jerry_value_t name)
+{
+    // effects: returns the module named by the JS string name, or -1
+    char buf[16];
+    jerry_size_t size = jerry_get_string_size(name);
+    if (size >= sizeof(buf)) {
+        return -1;
+    }
+    int len = jerry_string_to_char_buffer(name, (jerry_char_t *)buf, size);
+    buf[len] = '\0';
+
+    for (int i = 0; i < ZJS_MEM_MODULE_COUNT; i++) {
+        if (!strcmp(module_names[i], buf)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static jerry_value_t zjs_mem_stats(const jerry_value_t function_obj,
+                                   const jerry_value_t this,
+                                   const jerry_value_t argv[],
+                                   const jerry_length_t argc)
+{
+    //  effects: returns an object with a field per module, each holding its
+    //             used, peak, quota, denied, failed, allocs and blocks counts
+    jerry_value_t stats = jerry_create_object();
+    for (int i = 0; i < ZJS_MEM_MODULE_COUNT; i++) {
+        mem_usage_t *mod = &usage[i];
+        jerry_value_t entry = jerry_create_object();
+        zjs_obj_add_number(entry, mod->used, "used");
+        zjs_obj_add_number(entry, mod->peak, "peak");
+        zjs_obj_add_number(entry, mod->quota, "quota");
+        zjs_obj_add_number(entry, mod->denied, "denied");
+        zjs_obj_add_number(entry, mod->failed, "failed");
+        zjs_obj_add_number(entry, mod->allocs, "allocs");
+        zjs_obj_add_number(entry, mod->blocks, "blocks");
+        zjs_obj_add_object(stats, entry, module_names[i]);
+        jerry_release_value(entry);
+    }
+    return stats;
+}
+
+static jerry_value_t zjs_mem_quota(const jerry_value_t function_obj,
+                                   const jerry_value_t this,
+                                   const jerry_value_t argv[],
+                                   const jerry_length_t argc)
+{
+    // requires: arg[0] - module name string
+    //           arg[1] - quota in bytes, 0 to remove the quota
+    //  effects: sets the quota for the module
+    if (argc < 2 || !jerry_value_is_string(argv[0]) ||
+        !jerry_value_is_number(argv[1])) {
+        return zjs_error("zjs_mem_quota: invalid arguments");
+    }
+
+    int module = find_module(argv[0]);
+    if (module < 0) {
+        return zjs_error("zjs_mem_quota: unknown module");
+    }
+
+    zjs_mem_set_quota(module, (uint32_t)jerry_get_number_value(argv[1]));
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t zjs_mem_reset_peaks(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    //  effects: starts every module's peak over from what it uses now
+    for (int i = 0; i < ZJS_MEM_MODULE_COUNT; i++) {
+        usage[i].peak = usage[i].used;
+    }
+    total_peak = total_used;
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t zjs_mem_peak(const jerry_value_t function_obj,
+                                  const jerry_value_t this,
+                                  const jerry_value_t argv[],
+                                  const jerry_length_t argc)
+{
+    //  effects: returns the most bytes in use at once across all modules
+    return jerry_create_number(total_peak);
+}
+
+jerry_value_t zjs_mem_init()
+{
+    jerry_value_t mem_obj = jerry_create_object();
+    zjs_obj_add_function(mem_obj, zjs_mem_stats, "stats");
+    zjs_obj_add_function(mem_obj, zjs_mem_quota, "setQuota");
+    zjs_obj_add_function(mem_obj, zjs_mem_reset_peaks, "resetPeaks");
+    zjs_obj_add_function(mem_obj, zjs_mem_peak, "peak");
+    return mem_obj;
+}
+
+void zjs_mem_print_stats(void)
+{
+    uint32_t used = 0, peak = 0;
+    PRINT("module         used     peak    quota  denied  failed\n");
+    for (int i = 0; i < ZJS_MEM_MODULE_COUNT; i++) {
+        mem_usage_t *mod = &usage[i];
+        used += mod->used;
+        peak += mod->peak;
+        if (!mod->peak && !mod->quota && !mod->denied) {
+            continue;
+        }
+        PRINT("%-10s %8lu %8lu %8lu %7lu %7lu\n", module_names[i],
+              (unsigned long)mod->used, (unsigned long)mod->peak,
+              (unsigned long)mod->quota, (unsigned long)mod->denied,
+              (unsigned long)mod->failed);
+    }
+    // the sum of per module peaks is an upper bound on the real peak
+    PRINT("%-10s %8lu %8lu\n", "total", (unsigned long)used,
+          (unsigned long)peak);
+}
+
+void zjs_mem_print_report(void)
+{
+    uint32_t allocs = 0, blocks = 0;
+    for (int i = 0; i < ZJS_MEM_MODULE_COUNT; i++) {
+        allocs += usage[i].allocs;
+        blocks += usage[i].blocks;
+    }
+    // scripts/memfootprint parses this table, keep the format in step
+    PRINT("native heap        value\n");
+    PRINT("%-12s %11lu\n", "peak_bytes", (unsigned long)total_peak);
+    PRINT("%-12s %11lu\n", "live_bytes", (unsigned long)total_used);
+    PRINT("%-12s %11lu\n", "allocs", (unsigned long)allocs);
+    PRINT("%-12s %11lu\n", "live_blocks", (unsigned long)blocks);
+}
+
+#else
+
+#define HEADER_SIZE 0
+
+void zjs_mem_print_stats(void)
+{
+    PRINT("Memory stats not enabled, build with MEM_STATS=on\n");
+}
+
+void zjs_mem_print_report(void)
+{
+    zjs_mem_print_stats();
+}
+
+#endif  // ZJS_MEM_STATS
+
+static bool low_water = false;
+
+void *zjs_mem_malloc(uint32_t size, zjs_mem_module_t module)
+{
+    bool rescued = false;
+#ifdef ZJS_MEM_STATS
+    mem_usage_t *mod = &usage[module];
+    if (over_quota(mod, size)) {
+        // dead objects may still be holding some of the module's quota
+        if (!zjs_gc_reclaim() || over_quota(mod, size)) {
+            DBG_PRINT("%s over quota, %lu bytes refused\n",
+                      module_names[module], (unsigned long)size);
+            mod->denied++;
+            return NULL;
+        }
+        rescued = true;
+    }
+#endif
+
+    void *block = zjs_port_malloc(HEADER_SIZE + size);
+    if (!block) {
+        if (zjs_gc_reclaim()) {
+            block = zjs_port_malloc(HEADER_SIZE + size);
+        }
+        if (!block) {
+#ifdef ZJS_MEM_STATS
+            mod->failed++;
+#endif
+            return NULL;
+        }
+        rescued = true;
+    }
+    if (rescued) {
+        zjs_gc_count_rescue();
+    }
+
+#ifdef ZJS_MEM_STATS
+    mem_header_t *header = block;
+    header->h.size = size;
+    header->h.module = module;
+    mod->used += size;
+    if (mod->peak < mod->used) {
+        mod->peak = mod->used;
+    }
+    mod->allocs++;
+    mod->blocks++;
+    total_used += size;
+    if (total_peak < total_used) {
+        total_peak = total_used;
+    }
+    block = header + 1;
+#endif
+
+    // reclaim early when the allocator gets low, but only on the way down so
+    //   a program that sits near the mark doesn't GC on every allocation
+    if (zjs_port_low_water()) {
+        if (!low_water) {
+            low_water = true;
+            zjs_gc_count_low_water();
+            zjs_gc_reclaim();
+        }
+    } else {
+        low_water = false;
+    }
+    return block;
+}
+
+void zjs_mem_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+#ifdef ZJS_MEM_STATS
+    mem_header_t *header = (mem_header_t *)ptr - 1;
+    mem_usage_t *mod = &usage[header->h.module];
+    mod->used -= header->h.size;
+    mod->blocks--;
+    total_used -= header->h.size;
+    ptr = header;
+#endif
+    zjs_port_free(ptr);
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_mem_h__
+#define __zjs_mem_h__
+
+#include <stdint.h>
+
+#include "jerry-api.h"
+
+/*
+ * Per-module memory accounting, enabled with ZJS_MEM_STATS (make
+ * MEM_STATS=on, on by default for Linux).
+ *
+ * Every zjs_malloc is charged to ZJS_MEM_MODULE as defined where it is
+ * called. Source files that belong to a module define it before any include:
+ *
+ *     #define ZJS_MEM_MODULE ZJS_MEM_BLE
+ *
+ * and everything else is charged to ZJS_MEM_CORE. Once a module has a quota,
+ * an allocation that would take it over the quota fails with NULL instead of
+ * eating memory the other modules need.
+ *
+ * Each allocation carries an 8 byte header with its size and owner, so with
+ * the pool allocator blocks land in the next pool size up.
+ */
+
+typedef enum zjs_mem_module {
+    ZJS_MEM_CORE = 0,
+    ZJS_MEM_AIO,
+    ZJS_MEM_BLE,
+    ZJS_MEM_BUFFER,
+    ZJS_MEM_CALLBACKS,
+    ZJS_MEM_EVENTS,
+    ZJS_MEM_GPIO,
+    ZJS_MEM_GROVE_LCD,
+    ZJS_MEM_I2C,
+    ZJS_MEM_IPM,
+    ZJS_MEM_PROMISE,
+    ZJS_MEM_PWM,
+    ZJS_MEM_TIMERS,
+    ZJS_MEM_MODULE_COUNT
+} zjs_mem_module_t;
+
+// the allocator behind zjs_malloc/zjs_free, use those instead; on failure,
+//   or when the allocator runs low, it reclaims memory (see zjs_gc.h) and
+//   retries once
+void *zjs_mem_malloc(uint32_t size, zjs_mem_module_t module);
+void zjs_mem_free(void *ptr);
+
+#ifdef ZJS_MEM_STATS
+// effects: limits module to quota bytes in use, 0 for no limit
+void zjs_mem_set_quota(zjs_mem_module_t module, uint32_t quota);
+
+// effects: creates the object returned by require('memory')
+jerry_value_t zjs_mem_init();
+#endif
+
+// effects: prints current and peak usage per module to the console
+void zjs_mem_print_stats(void);
+
+// effects: prints the peak and live bytes and the allocation and live block
+//            counts across all modules, for jslinux --mem-report
+void zjs_mem_print_report(void);
+
+#endif  // __zjs_mem_h__
@@ -10,6 +10,9 @@
 // ZJS includes
 #include "zjs_event.h"
 #include "zjs_modules.h"
+#include "zjs_profile.h"
+#include "zjs_scope.h"
+#include "zjs_script.h"
 #include "zjs_util.h"
 
 #ifndef ZJS_LINUX_BUILD
@@ -31,82 +34,452 @@
 typedef struct module {
     const char *name;
     initcb_t init;
+    jerry_value_t instance;     // 0 until the first require
 } module_t;
 
+// keep sorted by name, require does a binary search
 module_t zjs_modules_array[] = {
-#ifndef ZJS_LINUX_BUILD
-#ifndef QEMU_BUILD
-#ifndef CONFIG_BOARD_FRDM_K64F
-#ifdef BUILD_MODULE_AIO
+#if !defined(ZJS_LINUX_BUILD) && !defined(QEMU_BUILD)
+#if !defined(CONFIG_BOARD_FRDM_K64F) && defined(BUILD_MODULE_AIO)
     { "aio", zjs_aio_init },
 #endif
+#if defined(CONFIG_BOARD_ARDUINO_101) && defined(BUILD_MODULE_A101)
+    { "arduino101_pins", zjs_a101_init },
 #endif
 #ifdef BUILD_MODULE_BLE
     { "ble", zjs_ble_init },
 #endif
+#endif // !ZJS_LINUX_BUILD && !QEMU_BUILD
+#ifdef BUILD_MODULE_EVENTS
+    { "events", zjs_event_init },
+#endif
+#if !defined(ZJS_LINUX_BUILD) && !defined(QEMU_BUILD)
 #ifdef BUILD_MODULE_GPIO
     { "gpio", zjs_gpio_init },
 #endif
 #ifdef BUILD_MODULE_GROVE_LCD
     { "grove_lcd", zjs_grove_lcd_init },
 #endif
-#ifdef BUILD_MODULE_PWM
-    { "pwm", zjs_pwm_init },
-#endif
 #ifdef BUILD_MODULE_I2C
     { "i2c", zjs_i2c_init },
 #endif
-#ifdef CONFIG_BOARD_ARDUINO_101
-#ifdef BUILD_MODULE_A101
-    { "arduino101_pins", zjs_a101_init },
-#endif
-#endif
 #ifdef CONFIG_BOARD_FRDM_K64F
     { "k64f_pins", zjs_k64f_init },
 #endif
-#endif // QEMU_BUILD
-#endif // ZJS_LINUX_BUILD
-
-#ifdef BUILD_MODULE_EVENTS
-    { "events", zjs_event_init },
+#endif // !ZJS_LINUX_BUILD && !QEMU_BUILD
+#ifdef ZJS_MEM_STATS
+    { "memory", zjs_mem_init },
+#endif
+#ifdef ZJS_PROFILE
+    { "profile", zjs_profile_init },
+#endif
+#if !defined(ZJS_LINUX_BUILD) && !defined(QEMU_BUILD)
+#ifdef BUILD_MODULE_PWM
+    { "pwm", zjs_pwm_init },
 #endif
+#endif // !ZJS_LINUX_BUILD && !QEMU_BUILD
 };
 
+#define MODULE_COUNT (sizeof(zjs_modules_array) / sizeof(module_t))
+
+static module_t *find_module(const char *name)
+{
+    // effects: returns the module called name, or NULL
+    int low = 0, high = MODULE_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(name, zjs_modules_array[mid].name);
+        if (cmp == 0)
+            return &zjs_modules_array[mid];
+        if (cmp < 0)
+            high = mid - 1;
+        else
+            low = mid + 1;
+    }
+    return NULL;
+}
+
+#define MAX_PATH_SIZE 64
+
+#ifdef ZJS_FILE_MODULES
+/*
+ * JS modules are files, named relative to the module that requires them or to
+ * the current directory for the application itself. The source is run inside
+ * a function, like node does, and the module object it gets is kept so later
+ * requires of the same file return the same exports.
+ *
+ * The first time a file is loaded its bytecode is saved next to it with a .snp
+ * extension, e.g. lib/util.js gets lib/util.snp, behind a header with the
+ * length and hash of the source. Loads after that run the bytecode without
+ * parsing as long as the header still matches the source; otherwise the file
+ * is parsed and the .snp overwritten.
+ */
+
+typedef struct js_module {
+    jerry_value_t module;
+    struct js_module *next;
+    char path[];
+} js_module_t;
+
+static js_module_t *js_modules = NULL;
+
+static const char wrap_start[] = "(function (exports, module, require) {";
+static const char wrap_end[] = "\n})";
+
+static jerry_value_t native_require_handler(const jerry_value_t function_obj,
+                                            const jerry_value_t this,
+                                            const jerry_value_t argv[],
+                                            const jerry_length_t argc);
+
+static bool is_file_module(const char *name)
+{
+    // effects: returns true if require should look for name as a JS file
+    size_t len = strlen(name);
+    return name[0] == '/' || !strncmp(name, "./", 2) ||
+        !strncmp(name, "../", 3) || (len > 3 && !strcmp(name + len - 3, ".js"));
+}
+
+static bool module_path(const char *base, const char *name, char *path)
+{
+    // requires: path has room for MAX_PATH_SIZE bytes; base is the directory
+    //             name is relative to, ending in / or empty
+    //  effects: writes the file name for require(name) to path, resolving .
+    //             and .. and adding .js if missing; returns false if too long
+    size_t len = 0;
+    if (name[0] != '/') {
+        len = strlen(base);
+        if (len >= MAX_PATH_SIZE) {
+            return false;
+        }
+        memcpy(path, base, len);
+    }
+    while (*name) {
+        const char *end = strchr(name, '/');
+        size_t seg = end ? end - name : strlen(name);
+        if (seg == 1 && name[0] == '.') {
+            // nothing to add
+        } else if (seg == 2 && !strncmp(name, "..", 2) && len > 0 &&
+                   !(len == 1 && path[0] == '/') &&
+                   !(len >= 3 && !strncmp(path + len - 3, "../", 3))) {
+            // drop the last directory
+            len--;
+            while (len > 0 && path[len - 1] != '/') {
+                len--;
+            }
+        } else if (seg > 0 || len == 0) {
+            if (len + seg + 1 >= MAX_PATH_SIZE) {
+                return false;
+            }
+            memcpy(path + len, name, seg);
+            len += seg;
+            if (end) {
+                path[len++] = '/';
+            }
+        }
+        name += end ? seg + 1 : seg;
+    }
+    if (len < 3 || strncmp(path + len - 3, ".js", 3)) {
+        if (len + 3 >= MAX_PATH_SIZE) {
+            return false;
+        }
+        memcpy(path + len, ".js", 3);
+        len += 3;
+    }
+    path[len] = '\0';
+    return true;
+}
+
+static size_t dir_length(const char *path)
+{
+    // effects: returns the length of the directory part of path, with its
+    //            trailing /
+    const char *slash = strrchr(path, '/');
+    return slash ? slash - path + 1 : 0;
+}
+
+static uint32_t hash_source(const char *src, uint32_t len)
+{
+    // effects: returns the 32-bit FNV-1a hash of src
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)src[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Saved bytecode starts with this header, so a snapshot left over from an
+//   older version of the source isn't run
+typedef struct snapshot_header {
+    uint32_t magic;
+    uint32_t hash;                  // hash_source of the module source
+    uint32_t length;                // bytes in the module source
+    uint32_t size;                  // bytes of bytecode after the header
+} snapshot_header_t;
+
+#define SNAPSHOT_MAGIC 0x706e737a   // "zsnp"
+
+static jerry_value_t compile_module(const char *path, const char *src,
+                                    uint32_t len)
+{
+    // requires: path ends in .js
+    //  effects: returns the function that runs the module source in src, from
+    //             its saved bytecode if that was made from the same source,
+    //             and otherwise by parsing it and saving the bytecode next to
+    //             path for next time
+    char snapshot[MAX_PATH_SIZE + 1];   // .snp is one longer than .js
+    size_t path_len = strlen(path);
+    memcpy(snapshot, path, path_len - 3);
+    strcpy(snapshot + path_len - 3, ".snp");
+
+    snapshot_header_t header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.hash = hash_source(src, len);
+    header.length = len;
+
+    const char *data;
+    uint32_t size;
+    if (zjs_read_file(snapshot, &data, &size)) {
+        jerry_value_t func = 0;
+        const snapshot_header_t *saved = (const snapshot_header_t *)data;
+        if (size >= sizeof(header) && saved->magic == header.magic &&
+            saved->hash == header.hash && saved->length == header.length &&
+            saved->size == size - sizeof(header)) {
+            func = jerry_exec_snapshot(data + sizeof(header), saved->size,
+                                       true);
+        }
+        zjs_free_file(data, size);
+        if (func) {
+            if (!jerry_value_has_error_flag(func)) {
+                return func;
+            }
+            // probably saved by another engine version
+            jerry_release_value(func);
+        }
+        // a stale snapshot gets overwritten below
+    }
+
+    uint32_t start_len = sizeof(wrap_start) - 1;
+    uint32_t end_len = sizeof(wrap_end) - 1;
+    uint32_t wrapped_len = start_len + len + end_len;
+    char *wrapped = zjs_malloc(wrapped_len);
+    if (!wrapped) {
+        return zjs_error("compile_module: out of memory");
+    }
+    memcpy(wrapped, wrap_start, start_len);
+    memcpy(wrapped + start_len, src, len);
+    memcpy(wrapped + start_len + len, wrap_end, end_len);
+
+    // bytecode is rarely much bigger than the source; if it doesn't fit, the
+    //   module just isn't cached
+    jerry_value_t func = 0;
+    size_t max = wrapped_len * 2 + 256;
+    uint8_t *buf = zjs_malloc(sizeof(header) + max);
+    if (buf) {
+        // saved as eval code, so running it returns the function
+        uint8_t *bytecode = buf + sizeof(header);
+        header.size = jerry_parse_and_save_snapshot(
+            (jerry_char_t *)wrapped, wrapped_len, false, false, bytecode, max);
+        if (header.size) {
+            memcpy(buf, &header, sizeof(header));
+            if (!zjs_write_file(snapshot, buf, sizeof(header) + header.size)) {
+                DBG_PRINT("can't save bytecode to %s\n", snapshot);
+            }
+            func = jerry_exec_snapshot(bytecode, header.size, true);
+        }
+        zjs_free(buf);
+    }
+    if (!func) {
+        // no snapshot support in the engine, or no memory for one
+        func = jerry_eval((jerry_char_t *)wrapped, wrapped_len, false);
+    }
+    zjs_free(wrapped);
+    return func;
+}
+
+static void free_require_dir(const uintptr_t handle)
+{
+    zjs_free((void *)handle);
+}
+
+static jerry_value_t create_require(const char *path)
+{
+    // effects: returns a require function that resolves names relative to
+    //            the directory of the module at path
+    jerry_value_t func = jerry_create_external_function(native_require_handler);
+    size_t len = dir_length(path);
+    char *dir = zjs_malloc(len + 1);
+    if (dir) {
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+        jerry_set_object_native_handle(func, (uintptr_t)dir, free_require_dir);
+    }
+    return func;
+}
+
+static void forget_module(js_module_t *mod)
+{
+    for (js_module_t **link = &js_modules; *link; link = &(*link)->next) {
+        if (*link == mod) {
+            *link = mod->next;
+            break;
+        }
+    }
+    jerry_release_value(mod->module);
+    zjs_free(mod);
+}
+
+static jerry_value_t require_file(const jerry_value_t require_obj,
+                                  const char *name)
+{
+    // effects: returns the exports of the JS file module name, loading and
+    //            running it the first time
+    char path[MAX_PATH_SIZE];
+    const char *base = "";
+    uintptr_t handle;
+    if (jerry_get_object_native_handle(require_obj, &handle)) {
+        base = (const char *)handle;
+    }
+    if (!module_path(base, name, path)) {
+        return zjs_error("require_file: path too long");
+    }
+
+    for (js_module_t *mod = js_modules; mod; mod = mod->next) {
+        if (!strcmp(mod->path, path)) {
+            return zjs_get_property(mod->module, "exports");
+        }
+    }
+
+    const char *src;
+    uint32_t len;
+    if (!zjs_read_file(path, &src, &len)) {
+        PRINT("MODULE: `%s'\n", path);
+        return zjs_error("require_file: module not found");
+    }
+    jerry_value_t func = compile_module(path, src, len);
+    zjs_free_file(src, len);
+    if (jerry_value_has_error_flag(func)) {
+        return func;
+    }
+
+    js_module_t *mod = zjs_malloc(sizeof(js_module_t) + strlen(path) + 1);
+    if (!mod) {
+        jerry_release_value(func);
+        return zjs_error("require_file: out of memory");
+    }
+    strcpy(mod->path, path);
+    mod->module = jerry_create_object();
+    jerry_value_t exports = jerry_create_object();
+    zjs_set_property(mod->module, "exports", exports);
+    // listed before it runs, so a require cycle gets the exports so far
+    //   instead of loading the file again
+    mod->next = js_modules;
+    js_modules = mod;
+
+    jerry_value_t require = create_require(path);
+    jerry_value_t args[] = { exports, mod->module, require };
+    jerry_value_t rval = jerry_call_function(func, exports, args, 3);
+    jerry_release_value(require);
+    jerry_release_value(exports);
+    jerry_release_value(func);
+    if (jerry_value_has_error_flag(rval)) {
+        // a later require should try again
+        forget_module(mod);
+        return rval;
+    }
+    jerry_release_value(rval);
+    return zjs_get_property(mod->module, "exports");
+}
+#endif // ZJS_FILE_MODULES
+
 static jerry_value_t native_require_handler(const jerry_value_t function_obj,
                                             const jerry_value_t this,
                                             const jerry_value_t argv[],
                                             const jerry_length_t argc)
 {
-    jerry_value_t arg = argv[0];
-    if (!jerry_value_is_string(arg)) {
+    // requires: arg[0] - module name, or the path of a JS file
+    //  effects: returns the module's object, initializing the module the
+    //             first time it's required; later calls get the same object
+    if (argc < 1 || !jerry_value_is_string(argv[0])) {
         return zjs_error("native_require_handler: invalid argument");
     }
 
-    const int maxlen = 32;
-    char module[maxlen];
-    jerry_size_t sz = jerry_get_string_size(arg);
-    if (sz >= maxlen) {
+    ZJS_SCOPE(scope);
+    char *name = zjs_scope_string(&scope, argv[0], MAX_PATH_SIZE - 1);
+    if (!name) {
         return zjs_error("native_require_handler: argument too long");
     }
-    int len = jerry_string_to_char_buffer(arg, (jerry_char_t *)module, sz);
-    module[len] = '\0';
 
-    int modcount = sizeof(zjs_modules_array) / sizeof(module_t);
-    for (int i = 0; i < modcount; i++) {
-        module_t *mod = &zjs_modules_array[i];
-        if (!strcmp(mod->name, module)) {
-            return jerry_acquire_value(mod->init());
-        }
+#ifdef ZJS_FILE_MODULES
+    if (is_file_module(name)) {
+        return require_file(function_obj, name);
     }
+#endif
 
-    PRINT("MODULE: `%s'\n", module);
-    return zjs_error("native_require_handler: module not found");
+    module_t *mod = find_module(name);
+    if (!mod) {
+        PRINT("MODULE: `%s'\n", name);
+        return zjs_error("native_require_handler: module not found");
+    }
+
+    if (!mod->instance) {
+        jerry_value_t instance = mod->init();
+        if (jerry_value_has_error_flag(instance)) {
+            return instance;
+        }
+        mod->instance = instance;
+    }
+    return jerry_acquire_value(mod->instance);
 }
 
 void zjs_modules_init()
 {
+#ifdef DEBUG_BUILD
+    for (int i = 1; i < MODULE_COUNT; i++) {
+        if (strcmp(zjs_modules_array[i - 1].name,
+                   zjs_modules_array[i].name) >= 0) {
+            PRINT("zjs_modules_init: module table not sorted at %s\n",
+                  zjs_modules_array[i].name);
+        }
+    }
+#endif
+
     jerry_value_t global_obj = jerry_get_global_object();
 
     // create the C handler for require JS call
     zjs_obj_add_function(global_obj, native_require_handler, "require");
 }
+
+#ifdef ZJS_FILE_MODULES
+void zjs_modules_set_path(const char *path)
+{
+    jerry_value_t global_obj = jerry_get_global_object();
+    jerry_value_t require = zjs_get_property(global_obj, "require");
+    size_t len = dir_length(path);
+    char *dir = zjs_malloc(len + 1);
+    if (dir && jerry_value_is_function(require)) {
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+        jerry_set_object_native_handle(require, (uintptr_t)dir,
+                                       free_require_dir);
+    } else {
+        zjs_free(dir);
+    }
+    jerry_release_value(require);
+    jerry_release_value(global_obj);
+}
+#endif
+
+void zjs_modules_cleanup()
+{
+#ifdef ZJS_FILE_MODULES
+    while (js_modules) {
+        forget_module(js_modules);
+    }
+#endif
+    for (int i = 0; i < MODULE_COUNT; i++) {
+        if (zjs_modules_array[i].instance) {
+            jerry_release_value(zjs_modules_array[i].instance);
+            zjs_modules_array[i].instance = 0;
+        }
+    }
+}
@@ -12,6 +12,12 @@
 typedef jerry_value_t (*initcb_t)();
 
 void zjs_modules_init();
+// effects: makes require() look for JS files relative to the directory of the
+//            application script at path, rather than the current directory
+void zjs_modules_set_path(const char *path);
+// effects: releases the module objects cached by require; call before
+//            jerry_cleanup()
+void zjs_modules_cleanup();
 void zjs_modules_add(const char *name, initcb_t mod_init);
 
 #endif  // __zjs_modules_h__
@@ -0,0 +1,186 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include <string.h>
+
+#include "zjs_pack.h"
+
+#define CACHE_SIZE 4
+
+typedef struct cache_entry {
+    char text[ZJS_PACK_FORMAT_MAX];
+    zjs_pack_format_t format;
+} cache_entry_t;
+
+static cache_entry_t cache[CACHE_SIZE];
+static uint8_t cache_next = 0;
+
+static uint8_t field_size(char code)
+{
+    // effects: returns the bytes a field code takes, or 0 if it's not one
+    switch (code) {
+    case 'b': case 'B': case 'x':
+        return 1;
+    case 'h': case 'H':
+        return 2;
+    case 'i': case 'I': case 'f':
+        return 4;
+    case 'd':
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static bool parse(const char *text, zjs_pack_format_t *format)
+{
+    // effects: parses text into format; returns false if it's not valid
+    memset(format, 0, sizeof(zjs_pack_format_t));
+    const char *p = text;
+    if (*p == '<') {
+        p++;
+    } else if (*p == '>' || *p == '!') {
+        format->big_endian = true;
+        p++;
+    }
+
+    while (*p) {
+        uint32_t count = 1;
+        if (*p >= '0' && *p <= '9') {
+            count = 0;
+            while (*p >= '0' && *p <= '9') {
+                count = count * 10 + *p++ - '0';
+                if (count > ZJS_PACK_MAX_VALUES)
+                    return false;
+            }
+        }
+
+        uint8_t size = field_size(*p);
+        if (!size)
+            return false;
+
+        // merge repeats of the same code into one run
+        zjs_pack_field_t *last = format->field_count ?
+            &format->fields[format->field_count - 1] : NULL;
+        if (last && last->code == *p) {
+            last->count += count;
+        } else {
+            if (format->field_count == ZJS_PACK_MAX_FIELDS)
+                return false;
+            zjs_pack_field_t *field = &format->fields[format->field_count++];
+            field->code = *p;
+            field->size = size;
+            field->count = count;
+        }
+
+        format->size += size * count;
+        if (*p != 'x')
+            format->value_count += count;
+        if (format->value_count > ZJS_PACK_MAX_VALUES)
+            return false;
+        p++;
+    }
+    return true;
+}
+
+const zjs_pack_format_t *zjs_pack_lookup(const char *format)
+{
+    if (strlen(format) >= ZJS_PACK_FORMAT_MAX)
+        return NULL;
+
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (cache[i].text[0] && !strcmp(cache[i].text, format))
+            return &cache[i].format;
+    }
+
+    // replace entries in turn; the common case is a handful of formats
+    zjs_pack_format_t parsed;
+    if (!parse(format, &parsed))
+        return NULL;
+    cache_entry_t *entry = &cache[cache_next];
+    entry->format = parsed;
+    strcpy(entry->text, format);
+    cache_next = (cache_next + 1) % CACHE_SIZE;
+    return &entry->format;
+}
+
+static uint64_t read_bits(const uint8_t *src, int size, bool big_endian)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < size; i++) {
+        bits = (bits << 8) | src[big_endian ? i : size - 1 - i];
+    }
+    return bits;
+}
+
+static void write_bits(uint8_t *dst, int size, bool big_endian, uint64_t bits)
+{
+    for (int i = 0; i < size; i++) {
+        dst[big_endian ? size - 1 - i : i] = bits & 0xff;
+        bits >>= 8;
+    }
+}
+
+void zjs_pack_read(const zjs_pack_format_t *format, const uint8_t *src,
+                   double *values)
+{
+    for (int f = 0; f < format->field_count; f++) {
+        const zjs_pack_field_t *field = &format->fields[f];
+        for (int i = 0; i < field->count; i++) {
+            uint64_t bits = read_bits(src, field->size, format->big_endian);
+            src += field->size;
+            switch (field->code) {
+            case 'x':
+                continue;
+            case 'b':
+                *values = (int8_t)bits;
+                break;
+            case 'h':
+                *values = (int16_t)bits;
+                break;
+            case 'i':
+                *values = (int32_t)bits;
+                break;
+            case 'f': {
+                uint32_t bits32 = bits;
+                float value;
+                memcpy(&value, &bits32, sizeof(value));
+                *values = value;
+                break;
+            }
+            case 'd':
+                memcpy(values, &bits, sizeof(double));
+                break;
+            default:
+                *values = bits;
+                break;
+            }
+            values++;
+        }
+    }
+}
+
+void zjs_pack_write(const zjs_pack_format_t *format, const double *values,
+                    uint8_t *dst)
+{
+    for (int f = 0; f < format->field_count; f++) {
+        const zjs_pack_field_t *field = &format->fields[f];
+        for (int i = 0; i < field->count; i++) {
+            uint64_t bits = 0;
+            if (field->code == 'f') {
+                float value = *values++;
+                uint32_t bits32;
+                memcpy(&bits32, &value, sizeof(bits32));
+                bits = bits32;
+            } else if (field->code == 'd') {
+                memcpy(&bits, values++, sizeof(bits));
+            } else if (field->code != 'x') {
+                // go through a signed type so negative values wrap
+                double value = *values++;
+                if (value == value && value > -9.2e18 && value < 9.2e18)
+                    bits = (uint64_t)(int64_t)value;
+            }
+            write_bits(dst, field->size, format->big_endian, bits);
+            dst += field->size;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_pack_h__
+#define __zjs_pack_h__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Binary record formats for Buffer pack and unpack. A format string is an
+ * optional byte order followed by field codes, each optionally preceded by a
+ * repeat count:
+ *
+ *     <  little endian (default)      b B  signed / unsigned 8-bit
+ *     >  big endian                   h H  signed / unsigned 16-bit
+ *     !  big endian (network)         i I  signed / unsigned 32-bit
+ *                                     f d  32-bit float / 64-bit double
+ *                                     x    pad byte, no value
+ *
+ * so "<HH2hf" is two unsigned shorts, two signed shorts and a float. Parsed
+ * formats are cached, since scripts tend to use the same few over and over.
+ */
+
+#define ZJS_PACK_FORMAT_MAX 32      // longest format string, with terminator
+#define ZJS_PACK_MAX_FIELDS 12      // runs of the same code after parsing
+#define ZJS_PACK_MAX_VALUES 64
+
+typedef struct zjs_pack_field {
+    char code;
+    uint8_t size;
+    uint16_t count;
+} zjs_pack_field_t;
+
+typedef struct zjs_pack_format {
+    bool big_endian;
+    uint8_t field_count;
+    uint16_t value_count;
+    uint32_t size;                  // bytes in a record
+    zjs_pack_field_t fields[ZJS_PACK_MAX_FIELDS];
+} zjs_pack_format_t;
+
+// effects: returns the parsed form of format, from the cache if it was used
+//            recently, or NULL if format isn't valid; the result is only good
+//            until the next lookup, so copy it before running any JS
+const zjs_pack_format_t *zjs_pack_lookup(const char *format);
+
+// requires: src has format->size bytes, values has room for
+//             format->value_count numbers
+//  effects: decodes a record from src into values
+void zjs_pack_read(const zjs_pack_format_t *format, const uint8_t *src,
+                   double *values);
+
+// requires: dst has room for format->size bytes, values has
+//             format->value_count numbers
+//  effects: encodes values into a record at dst, truncating each to its field
+void zjs_pack_write(const zjs_pack_format_t *format, const double *values,
+                    uint8_t *dst);
+
+#endif  // __zjs_pack_h__
@@ -0,0 +1,33 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// ZJS includes
+#include "zjs_pins.h"
+#include "zjs_util.h"
+
+void zjs_pin_convert(const zjs_pin_map_t *map, uint32_t num, int *dev,
+                     int *pin)
+{
+    if (!map) {
+        zjs_default_convert_pin(num, dev, pin);
+        return;
+    }
+
+    uint8_t entry = num < map->size ? map->map[num] : 0;
+    if (!entry) {
+        *dev = 0;
+        *pin = -1;
+        return;
+    }
+    entry--;
+    *dev = entry >> 5;
+    *pin = entry & 0x1f;
+}
+
+jerry_value_t zjs_pins_create(const zjs_pin_name_t *names, int count)
+{
+    jerry_value_t obj = jerry_create_object();
+    for (int i = 0; i < count; i++) {
+        zjs_obj_add_number(obj, names[i].num, names[i].name);
+    }
+    return obj;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_pins_h__
+#define __zjs_pins_h__
+
+#include <stdint.h>
+
+#include "jerry-api.h"
+
+/*
+ * Board pin tables. Both kinds of table are const so they stay in ROM:
+ *
+ * A pin map converts the number a script passes to open() into a device and
+ * pin by indexing an array with it, so the lookup costs the same for every
+ * pin. Entries are written with ZJS_PIN(dev, pin); numbers the board doesn't
+ * support are left out and read as zero:
+ *
+ *     static const uint8_t pwm_map[] = {
+ *         [17] = ZJS_PIN(0, 0),  // IO3
+ *     };
+ *     const zjs_pin_map_t board_pwm_pins = ZJS_PIN_MAP(pwm_map);
+ *
+ * A name table lists the names a board's pins module exports to scripts.
+ */
+
+// entries are stored plus one so zero can mean unsupported; this leaves out
+//   only pin 31 of device 7
+#define ZJS_PIN(dev, pin) ((((dev) << 5) | (pin)) + 1)
+
+#define ZJS_PIN_MAP(array) { array, sizeof(array) / sizeof(array[0]) }
+
+typedef struct zjs_pin_map {
+    const uint8_t *map;
+    uint8_t size;
+} zjs_pin_map_t;
+
+#define ZJS_PIN_NAME_LEN 5
+
+typedef struct zjs_pin_name {
+    char name[ZJS_PIN_NAME_LEN];
+    uint8_t num;
+} zjs_pin_name_t;
+
+// effects: converts num to a device and pin through map, or with
+//            zjs_default_convert_pin if map is NULL; writes -1 to pin if num
+//            isn't supported
+void zjs_pin_convert(const zjs_pin_map_t *map, uint32_t num, int *dev,
+                     int *pin);
+
+// effects: returns a new object with a number property for each of the count
+//            entries in names
+jerry_value_t zjs_pins_create(const zjs_pin_name_t *names, int count);
+
+#endif  // __zjs_pins_h__
@@ -48,27 +48,32 @@ typedef struct pool_map {
 typedef struct pool_lookup {
     uint32_t size;
     uint32_t pool_id;
+    // must match BLOCK_NUMBER for the pool in the top level Makefile
+    uint32_t blocks;
+    uint32_t used;
 } pool_lookup_t;
 
 static pool_lookup_t lookup[] = {
-    { 8,    POOL_8 },
-    { 16,   POOL_16 },
-    { 36,   POOL_36 },
-    { 64,   POOL_64 },
-    { 128,  POOL_128 },
-    { 256,  POOL_256 }
+    { 8,    POOL_8,     64 },
+    { 16,   POOL_16,    32 },
+    { 36,   POOL_36,    16 },
+    { 64,   POOL_64,    10 },
+    { 128,  POOL_128,   4 },
+    { 256,  POOL_256,   2 }
 };
 
 #define MAX_CONCURRENT_POINTERS  64
 
-static pool_map_t pointer_map[MAX_CONCURRENT_POINTERS];
+// a pool, or the pointer map, is running low once only this fraction is left
+#define LOW_WATER_DIVISOR        8
+
+static uint32_t pointers_in_use = 0;
 
-#define POOL_SIZE_TOO_SMALL     0xFFFFFFFF
+static pool_map_t pointer_map[MAX_CONCURRENT_POINTERS];
 
 #ifdef DUMP_MEM_STATS
 static uint32_t mem_high_water = 0;
 static uint32_t mem_in_use = 0;
-static uint32_t pointers_used = 0;
 static uint32_t max_pointers_used = 0;
 static uint32_t max_waste = 0;
 
@@ -105,7 +110,7 @@ void zjs_print_pools(void)
     }
     PRINT("Memory Used: %lu, High Water: %lu\n", mem_in_use, mem_high_water);
     PRINT("Memory Waste: %lu, Max Waste: %lu\n", total_waste, max_waste);
-    PRINT("Pointers Used: %lu, Max Used: %lu\n", pointers_used, max_pointers_used);
+    PRINT("Pointers Used: %lu, Max Used: %lu\n", pointers_in_use, max_pointers_used);
 }
 #else
 #define zjs_print_pools(void) do {} while (0);
@@ -122,95 +127,79 @@ void zjs_init_mem_pools(void)
     }
 }
 
-static uint32_t find_pool_id(uint32_t size)
+static pool_lookup_t *find_pool(uint32_t size)
 {
     int i;
     for (i = 0; i < (sizeof(lookup) / sizeof(lookup[0])); ++i) {
         if (size <= lookup[i].size) {
-            return lookup[i].pool_id;
+            return &lookup[i];
         }
     }
-    DBG_PRINT("no pool ID found\n");
-    return 0;
+    return NULL;
 }
 
-#ifdef DUMP_MEM_STATS
-static void add_pointer(void* ptr, uint32_t req_size, uint32_t size, uint32_t pool_size)
-#else
-static void add_pointer(void* ptr, uint32_t req_size)
-
-#endif
+static pool_map_t *find_free_pointer(void)
 {
     int i;
     for (i = 0; i < MAX_CONCURRENT_POINTERS; ++i) {
         if (pointer_map[i].ptr == NULL) {
-            pointer_map[i].ptr = ptr;
-            pointer_map[i].req_size = req_size;
-#ifdef DUMP_MEM_STATS
-            pointer_map[i].req_size = size;
-            pointer_map[i].pool_size = pool_size;
-            mem_in_use += size;
-            if (mem_in_use > mem_high_water) {
-                mem_high_water = mem_in_use;
-            }
-#endif
-            return;
+            return &pointer_map[i];
         }
     }
+    return NULL;
 }
 
-#ifdef DUMP_MEM_STATS
-static uint32_t lookup_pool(uint32_t size, uint32_t* pool_size)
-#else
-static uint32_t lookup_pool(uint32_t size)
-
-#endif
+bool pool_low_water(void)
 {
+    // effects: returns true if the pointer map or any pool is nearly full
     int i;
+    if (MAX_CONCURRENT_POINTERS - pointers_in_use <=
+        MAX_CONCURRENT_POINTERS / LOW_WATER_DIVISOR) {
+        return true;
+    }
     for (i = 0; i < (sizeof(lookup) / sizeof(lookup[0])); ++i) {
-        if (size <= lookup[i].size) {
-#ifdef DUMP_MEM_STATS
-            *pool_size = lookup[i].size;
-#endif
-            return lookup[i].pool_id;
+        if (lookup[i].blocks - lookup[i].used <=
+            lookup[i].blocks / LOW_WATER_DIVISOR) {
+            return true;
         }
     }
-    return POOL_SIZE_TOO_SMALL;
+    return false;
 }
 
 void* pool_malloc(uint32_t size)
 {
     int ret;
     struct k_block block;
-    uint32_t pool;
-#ifdef DUMP_MEM_STATS
-    uint32_t pool_size;
-    pool = lookup_pool(size, &pool_size);
-#else
-    pool = lookup_pool(size);
-#endif
-    if (pool == POOL_SIZE_TOO_SMALL) {
+    pool_lookup_t *pool = find_pool(size);
+    if (!pool) {
         DBG_PRINT("no pool size big enough for %lu bytes\n", size);
         return NULL;
     }
-    ret = task_mem_pool_alloc(&block, pool, size, TICKS_NONE);
+    // without a free slot in the map the block could never be freed
+    pool_map_t *entry = find_free_pointer();
+    if (!entry) {
+        DBG_PRINT("too many concurrent pointers\n");
+        return NULL;
+    }
+    ret = task_mem_pool_alloc(&block, pool->pool_id, size, TICKS_NONE);
     if (ret != RC_OK) {
         DBG_PRINT("task_mem_pool_alloc() returned an error: %u\n", ret);
         return NULL;
     }
+    entry->ptr = block.pointer_to_data;
+    entry->req_size = block.req_size;
+    pool->used++;
+    pointers_in_use++;
 #ifdef DUMP_MEM_STATS
-    add_pointer(block.pointer_to_data, block.req_size, size, pool_size);
-    pointers_used++;
-    if (max_pointers_used < pointers_used) {
-        max_pointers_used = pointers_used;
+    entry->req_size = size;
+    entry->pool_size = pool->size;
+    mem_in_use += size;
+    if (mem_in_use > mem_high_water) {
+        mem_high_water = mem_in_use;
+    }
+    if (max_pointers_used < pointers_in_use) {
+        max_pointers_used = pointers_in_use;
     }
-#else
-    add_pointer(block.pointer_to_data, block.req_size);
-#endif
-#ifdef ZJS_TRACE_MALLOC
-#ifdef DUMP_MEM_STATS
-    PRINT("\tpool size=%lu\n", pool_size);
-#endif
 #endif
 
     zjs_print_pools();
@@ -224,21 +213,18 @@ void pool_free(void* ptr)
     for (i = 0; i < MAX_CONCURRENT_POINTERS; ++i) {
         if (pointer_map[i].ptr == ptr) {
             struct k_block block;
+            pool_lookup_t *pool = find_pool(pointer_map[i].req_size);
             block.address_in_pool = pointer_map[i].ptr;
             block.pointer_to_data = pointer_map[i].ptr;
             block.req_size = pointer_map[i].req_size;
-            block.pool_id = find_pool_id(pointer_map[i].req_size);
+            block.pool_id = pool->pool_id;
 #ifdef DUMP_MEM_STATS
             mem_in_use -= pointer_map[i].req_size;
-            pointers_used--;
-#endif
-#ifdef ZJS_TRACE_MALLOC
-#ifdef DUMP_MEM_STATS
-            PRINT("\tpointer size=%lu bytes\n", pointer_map[i].req_size);
-#endif
 #endif
             task_mem_pool_free(&block);
             pointer_map[i].ptr = NULL;
+            pool->used--;
+            pointers_in_use--;
             zjs_print_pools();
             return;
         }
@@ -4,12 +4,17 @@
 #define SRC_ZJS_POOL_H_
 
 #ifdef ZJS_POOL_CONFIG
+#include <stdbool.h>
+
 void zjs_init_mem_pools(void);
 
 void* pool_malloc(uint32_t size);
 
 void pool_free(void* ptr);
 
+// effects: returns true when any pool is close to running out of blocks
+bool pool_low_water(void);
+
 void zjs_print_pools(void);
 #endif // ZJS_POOL_CONFIG
 
@@ -0,0 +1,117 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifdef ZJS_PROFILE
+
+#ifndef ZJS_LINUX_BUILD
+#include "zjs_zephyr_time.h"
+#else
+#include "zjs_linux_time.h"
+#endif
+
+#include "zjs_common.h"
+#include "zjs_profile.h"
+#include "zjs_promise.h"
+#include "zjs_util.h"
+
+#define MAX_PHASES 12
+
+typedef struct phase {
+    const char *name;
+    uint32_t us;
+} phase_t;
+
+static phase_t phases[MAX_PHASES];
+static uint8_t phase_count = 0;
+static uint32_t last_mark = 0;
+
+void zjs_profile_start(void)
+{
+    phase_count = 0;
+    last_mark = zjs_port_get_us();
+}
+
+void zjs_profile_mark(const char *phase)
+{
+    uint32_t now = zjs_port_get_us();
+    if (phase_count < MAX_PHASES) {
+        phases[phase_count].name = phase;
+        phases[phase_count].us = now - last_mark;
+        phase_count++;
+    }
+    // read the clock again so the bookkeeping isn't charged to the next phase
+    last_mark = zjs_port_get_us();
+}
+
+static uint32_t total_us(void)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < phase_count; i++) {
+        total += phases[i].us;
+    }
+    return total;
+}
+
+void zjs_profile_print(void)
+{
+    // scripts/startupbench parses this table, keep the format in step
+    PRINT("startup phase  time (us)\n");
+    for (int i = 0; i < phase_count; i++) {
+        PRINT("%-12s %11lu\n", phases[i].name, (unsigned long)phases[i].us);
+    }
+    PRINT("%-12s %11lu\n", "total", (unsigned long)total_us());
+#ifdef ZJS_LINUX_BUILD
+    // callbacks may run for a long time yet, or forever with --forever, so
+    //   don't leave the table sitting in a pipe buffer until exit
+    fflush(stdout);
+#endif
+}
+
+static jerry_value_t zjs_profile_startup(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    //  effects: returns an object with the microseconds spent in each startup
+    //             phase recorded so far, in order, followed by the total
+    jerry_value_t obj = jerry_create_object();
+    for (int i = 0; i < phase_count; i++) {
+        zjs_obj_add_number(obj, phases[i].us, phases[i].name);
+    }
+    zjs_obj_add_number(obj, total_us(), "total");
+    return obj;
+}
+
+static jerry_value_t zjs_profile_now(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    //  effects: returns the microsecond clock the phases are timed with; it
+    //             wraps at 2^32, so only differences are meaningful
+    return jerry_create_number(zjs_port_get_us());
+}
+
+static jerry_value_t zjs_profile_promise(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    //  effects: returns a native promise that is already fulfilled, with no
+    //             arguments, so its then() callback runs from the main loop;
+    //             this times the same path the hardware modules' promises take
+    jerry_value_t promise = jerry_create_object();
+    zjs_make_promise(promise, NULL, NULL);
+    zjs_fulfill_promise(promise, NULL, 0);
+    return promise;
+}
+
+jerry_value_t zjs_profile_init()
+{
+    jerry_value_t profile_obj = jerry_create_object();
+    zjs_obj_add_function(profile_obj, zjs_profile_startup, "startup");
+    zjs_obj_add_function(profile_obj, zjs_profile_now, "now");
+    zjs_obj_add_function(profile_obj, zjs_profile_promise, "promise");
+    return profile_obj;
+}
+
+#endif  // ZJS_PROFILE
@@ -0,0 +1,50 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_profile_h__
+#define __zjs_profile_h__
+
+#include <stdint.h>
+
+#include "jerry-api.h"
+
+/*
+ * Startup phase timing, enabled with ZJS_PROFILE (make PROFILE=on).
+ *
+ * main() marks the end of each boot phase; every mark records the time spent
+ * since the previous one, so the summary reads as a breakdown of the time to
+ * the first JS statement:
+ *
+ *     zjs_profile_start();
+ *     jerry_init(JERRY_INIT_EMPTY);
+ *     zjs_profile_mark("jerry_init");
+ *
+ * The phases are also available to scripts through require('profile'), and
+ * scripts/startupbench compares them across runs to catch regressions.
+ *
+ * Without ZJS_PROFILE the calls compile away.
+ */
+
+#ifdef ZJS_PROFILE
+
+// effects: starts the clock for the first phase
+void zjs_profile_start(void);
+
+// requires: phase is a string constant
+//  effects: records the time since the previous mark under phase
+void zjs_profile_mark(const char *phase);
+
+// effects: prints each phase and the total to the console
+void zjs_profile_print(void);
+
+// effects: creates the object returned by require('profile')
+jerry_value_t zjs_profile_init();
+
+#else
+
+#define zjs_profile_start() do {} while (0)
+#define zjs_profile_mark(phase) do {} while (0)
+#define zjs_profile_print() do {} while (0)
+
+#endif  // ZJS_PROFILE
+
+#endif  // __zjs_profile_h__
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_PROMISE
 
 #include <string.h>
 #include "zjs_util.h"
@@ -73,7 +74,7 @@ static jerry_value_t promise_then(const jerry_value_t function_obj,
 {
     struct promise* handle = NULL;
 
-    jerry_value_t promise_obj = zjs_get_property(this, "promise");
+    jerry_value_t promise_obj = zjs_get_property_id(this, ZJS_PROP_PROMISE);
     jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
 
     if (jerry_value_is_function(argv[0])) {
@@ -105,7 +106,7 @@ static jerry_value_t promise_catch(const jerry_value_t function_obj,
 {
     struct promise* handle = NULL;
 
-    jerry_value_t promise_obj = zjs_get_property(this, "promise");
+    jerry_value_t promise_obj = zjs_get_property_id(this, ZJS_PROP_PROMISE);
     jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
 
     if (handle) {
@@ -136,7 +137,7 @@ void zjs_make_promise(jerry_value_t obj, zjs_post_promise_func post,
 
     // Add the "promise" object to the object passed as a property, because the
     // object being made to a promise may already have a native handle.
-    zjs_obj_add_object(obj, promise_obj, "promise");
+    zjs_obj_add_object_id(obj, promise_obj, ZJS_PROP_PROMISE);
 
     DBG_PRINT("created promise, obj=%lu, promise=%p, handle=%p\n", obj, new,
               handle);
@@ -145,7 +146,7 @@ void zjs_make_promise(jerry_value_t obj, zjs_post_promise_func post,
 void zjs_fulfill_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
 {
     struct promise* handle;
-    jerry_value_t promise_obj = zjs_get_property(obj, "promise");
+    jerry_value_t promise_obj = zjs_get_property_id(obj, ZJS_PROP_PROMISE);
 
     jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
 
@@ -170,7 +171,7 @@ void zjs_fulfill_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
 void zjs_reject_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
 {
     struct promise* handle;
-    jerry_value_t promise_obj = zjs_get_property(obj, "promise");
+    jerry_value_t promise_obj = zjs_get_property_id(obj, ZJS_PROP_PROMISE);
 
     jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
 
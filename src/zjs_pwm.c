@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_PWM
 #ifdef BUILD_MODULE_PWM
 // Zephyr includes
 #include <zephyr.h>
@@ -21,51 +22,65 @@ static const char *ZJS_POLARITY_REVERSE = "reverse";
 
 static struct device *zjs_pwm_dev[PWM_DEV_COUNT];
 
-void (*zjs_pwm_convert_pin)(uint32_t orig, int *dev, int *pin) =
-    zjs_default_convert_pin;
+const zjs_pin_map_t *zjs_pwm_pins = NULL;
 
-static void zjs_pwm_set(jerry_value_t obj, double periodHW, double pulseWidthHW)
+// Native handle of a PWMPin object, so setting the timing doesn't have to
+//   look up and convert the channel and polarity again
+typedef struct pwm_pin {
+    struct device *port;
+    int channel;
+    bool reverse;
+    double period_hw;
+    double pulse_width_hw;
+} pwm_pin_t;
+
+// hardware cycles per millisecond
+static double cycles_per_ms;
+
+static void zjs_pwm_free_pin(const uintptr_t native)
 {
-    uint32_t orig_chan;
-    zjs_obj_get_uint32(obj, "channel", &orig_chan);
+    zjs_free((pwm_pin_t *)native);
+}
 
-    int devnum, channel;
-    zjs_pwm_convert_pin(orig_chan, &devnum, &channel);
+static pwm_pin_t *zjs_pwm_get_pin(const jerry_value_t obj)
+{
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_PWM_PIN) ||
+        !jerry_get_object_native_handle(obj, &native)) {
+        return NULL;
+    }
+    return (pwm_pin_t *)native;
+}
 
-    if (pulseWidthHW > periodHW) {
+static void zjs_pwm_set(pwm_pin_t *pin)
+{
+    double pulseWidthHW = pin->pulse_width_hw;
+    if (pulseWidthHW > pin->period_hw) {
         PRINT("zjs_pwm_set: pulseWidth was greater than period\n");
-        pulseWidthHW = periodHW;
+        pulseWidthHW = pin->period_hw;
     }
 
-    const int BUFLEN = 10;
-    char buffer[BUFLEN];
-    if (zjs_obj_get_string(obj, "polarity", buffer, BUFLEN)) {
-        if (!strcmp(buffer, ZJS_POLARITY_REVERSE))
-            pulseWidthHW = periodHW - pulseWidthHW;
-    }
+    if (pin->reverse)
+        pulseWidthHW = pin->period_hw - pulseWidthHW;
 
     // convert to milliseconds
-    uint32_t period = periodHW / sys_clock_hw_cycles_per_sec * 1000;
+    uint32_t period = pin->period_hw / cycles_per_ms;
 
     // convert to microseconds
-    pwm_pin_set_period(zjs_pwm_dev[devnum], channel, (uint32_t)(period * 1000));
-    pwm_pin_set_values(zjs_pwm_dev[devnum], channel, 0, pulseWidthHW);
+    pwm_pin_set_period(pin->port, pin->channel, (uint32_t)(period * 1000));
+    pwm_pin_set_values(pin->port, pin->channel, 0, pulseWidthHW);
 }
 
-static void zjs_pwm_set_period_cycles(jerry_value_t obj, double periodHW)
+static void zjs_pwm_set_period_cycles(jerry_value_t obj, pwm_pin_t *pin,
+                                      double periodHW)
 {
-    // requires: obj is a PWM pin object, period is in hardware cycles
+    // requires: obj is a PWM pin object, pin its handle, period is in hardware
+    //             cycles
     //  effects: sets the PWM pin to the given period, records the period
     //             in the object
-    double pulseWidth;
-    zjs_obj_get_double(obj, "pulseWidth", &pulseWidth);
-
-    // update the JS object
-    double period = periodHW / sys_clock_hw_cycles_per_sec * 1000;
-    zjs_obj_add_number(obj, period, "period");
-
-    double pulseWidthHW = pulseWidth * sys_clock_hw_cycles_per_sec / 1000;
-    zjs_pwm_set(obj, periodHW, pulseWidthHW);
+    pin->period_hw = periodHW;
+    zjs_obj_add_number(obj, periodHW / cycles_per_ms, "period");
+    zjs_pwm_set(pin);
 }
 
 static jerry_value_t zjs_pwm_pin_set_period_cycles(const jerry_value_t function_obj,
@@ -81,9 +96,13 @@ static jerry_value_t zjs_pwm_pin_set_period_cycles(const jerry_value_t function_
     if (argc < 1 || !jerry_value_is_number(argv[0]))
         return zjs_error("zjs_pwm_pin_set_period_cycles: invalid argument");
 
+    pwm_pin_t *pin = zjs_pwm_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_pwm_pin_set_period_cycles: not a PWM pin");
+
     double periodHW = jerry_get_number_value(argv[0]);
 
-    zjs_pwm_set_period_cycles(this, periodHW);
+    zjs_pwm_set_period_cycles(this, pin, periodHW);
     return ZJS_UNDEFINED;
 }
 
@@ -99,29 +118,27 @@ static jerry_value_t zjs_pwm_pin_set_period(const jerry_value_t function_obj,
     if (argc < 1 || !jerry_value_is_number(argv[0]))
         return zjs_error("zjs_pwm_pin_set_period: invalid argument");
 
+    pwm_pin_t *pin = zjs_pwm_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_pwm_pin_set_period: not a PWM pin");
+
     // convert to hardware cycles
     double period = jerry_get_number_value(argv[0]);
-    double periodHW = period * sys_clock_hw_cycles_per_sec / 1000;
 
-    zjs_pwm_set_period_cycles(this, periodHW);
+    zjs_pwm_set_period_cycles(this, pin, period * cycles_per_ms);
     return ZJS_UNDEFINED;
 }
 
-static void zjs_pwm_set_pulse_width_cycles(jerry_value_t obj,
+static void zjs_pwm_set_pulse_width_cycles(jerry_value_t obj, pwm_pin_t *pin,
                                            double pulseWidthHW)
 {
-    // requires: obj is a PWM pin object, pulseWidth is in hardware cycles
+    // requires: obj is a PWM pin object, pin its handle, pulseWidth is in
+    //             hardware cycles
     //  effects: sets the PWM pin to the given pulse width, records the pulse
     //             width in the object
-    double period;
-    zjs_obj_get_double(obj, "period", &period);
-
-    // update the JS object
-    double pulseWidth = pulseWidthHW / sys_clock_hw_cycles_per_sec * 1000;
-    zjs_obj_add_number(obj, pulseWidth, "pulseWidth");
-
-    double periodHW = period * sys_clock_hw_cycles_per_sec / 1000;
-    zjs_pwm_set(obj, periodHW, pulseWidthHW);
+    pin->pulse_width_hw = pulseWidthHW;
+    zjs_obj_add_number(obj, pulseWidthHW / cycles_per_ms, "pulseWidth");
+    zjs_pwm_set(pin);
 }
 
 static jerry_value_t zjs_pwm_pin_set_pulse_width_cycles(const jerry_value_t function_obj,
@@ -136,9 +153,13 @@ static jerry_value_t zjs_pwm_pin_set_pulse_width_cycles(const jerry_value_t func
     if (argc < 1 || !jerry_value_is_number(argv[0]))
         return zjs_error("zjs_pwm_pin_set_pulse_width_cycles: invalid argument");
 
+    pwm_pin_t *pin = zjs_pwm_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_pwm_pin_set_pulse_width_cycles: not a PWM pin");
+
     double pulseWidthHW = jerry_get_number_value(argv[0]);
 
-    zjs_pwm_set_pulse_width_cycles(this, pulseWidthHW);
+    zjs_pwm_set_pulse_width_cycles(this, pin, pulseWidthHW);
     return ZJS_UNDEFINED;
 }
 
@@ -153,14 +174,25 @@ static jerry_value_t zjs_pwm_pin_set_pulse_width(const jerry_value_t function_ob
     if (argc < 1 || !jerry_value_is_number(argv[0]))
         return zjs_error("zjs_pwm_pin_set_pulse_width: invalid argument");
 
+    pwm_pin_t *pin = zjs_pwm_get_pin(this);
+    if (!pin)
+        return zjs_error("zjs_pwm_pin_set_pulse_width: not a PWM pin");
+
     // convert to hardware cycles
     double pulseWidth = jerry_get_number_value(argv[0]);
-    double pulseWidthHW = pulseWidth * sys_clock_hw_cycles_per_sec / 1000;
 
-    zjs_pwm_set_pulse_width_cycles(this, pulseWidthHW);
+    zjs_pwm_set_pulse_width_cycles(this, pin, pulseWidth * cycles_per_ms);
     return ZJS_UNDEFINED;
 }
 
+static const zjs_native_func_t pwm_pin_funcs[] = {
+    { zjs_pwm_pin_set_period, "setPeriod" },
+    { zjs_pwm_pin_set_period_cycles, "setPeriodCycles" },
+    { zjs_pwm_pin_set_pulse_width, "setPulseWidth" },
+    { zjs_pwm_pin_set_pulse_width_cycles, "setPulseWidthCycles" },
+    { NULL, NULL }
+};
+
 static jerry_value_t zjs_pwm_open(const jerry_value_t function_obj,
                                   const jerry_value_t this,
                                   const jerry_value_t argv[],
@@ -177,11 +209,11 @@ static jerry_value_t zjs_pwm_open(const jerry_value_t function_obj,
     jerry_value_t data = argv[0];
 
     uint32_t channel;
-    if (!zjs_obj_get_uint32(data, "channel", &channel))
+    if (!zjs_obj_get_uint32_id(data, ZJS_PROP_CHANNEL, &channel))
         return zjs_error("zjs_pwm_open: missing required field");
 
     int devnum, newchannel;
-    zjs_pwm_convert_pin(channel, &devnum, &newchannel);
+    zjs_pin_convert(zjs_pwm_pins, channel, &devnum, &newchannel);
     if (newchannel == -1)
         return zjs_error("zjs_pwm_open: invalid channel");
 
@@ -192,30 +224,32 @@ static jerry_value_t zjs_pwm_open(const jerry_value_t function_obj,
     const int BUFLEN = 10;
     char buffer[BUFLEN];
     const char *polarity = ZJS_POLARITY_NORMAL;
-    if (zjs_obj_get_string(data, "polarity", buffer, BUFLEN)) {
+    if (zjs_obj_get_string_id(data, ZJS_PROP_POLARITY, buffer, BUFLEN)) {
         if (!strcmp(buffer, ZJS_POLARITY_REVERSE))
             polarity = ZJS_POLARITY_REVERSE;
     }
 
+    pwm_pin_t *pin = zjs_malloc(sizeof(pwm_pin_t));
+    if (!pin)
+        return zjs_error("zjs_pwm_open: could not allocate handle");
+    pin->port = zjs_pwm_dev[devnum];
+    pin->channel = newchannel;
+    pin->reverse = polarity == ZJS_POLARITY_REVERSE;
+
     // set the inital timing
-    uint32_t pulseWidthHW = pulseWidth * sys_clock_hw_cycles_per_sec / 1000;
-    uint32_t periodHW = period * sys_clock_hw_cycles_per_sec / 1000;
+    uint32_t pulseWidthHW = pulseWidth * cycles_per_ms;
+    uint32_t periodHW = period * cycles_per_ms;
+    pin->pulse_width_hw = pulseWidthHW;
 
     // create the PWMPin object
-    jerry_value_t pin_obj = jerry_create_object();
-    zjs_obj_add_function(pin_obj, zjs_pwm_pin_set_period, "setPeriod");
-    zjs_obj_add_function(pin_obj, zjs_pwm_pin_set_period_cycles,
-                         "setPeriodCycles");
-    zjs_obj_add_function(pin_obj, zjs_pwm_pin_set_pulse_width, "setPulseWidth");
-    zjs_obj_add_function(pin_obj, zjs_pwm_pin_set_pulse_width_cycles,
-                         "setPulseWidthCycles");
-    zjs_obj_add_number(pin_obj, channel, "channel");
-    zjs_obj_add_number(pin_obj, period, "period");
-    zjs_obj_add_number(pin_obj, pulseWidth, "pulseWidth");
-    zjs_obj_add_string(pin_obj, polarity, "polarity");
-
-    zjs_pwm_set_period_cycles(pin_obj, periodHW);
-    zjs_pwm_set_pulse_width_cycles(pin_obj, pulseWidthHW);
+    jerry_value_t pin_obj = zjs_create_instance(ZJS_CLASS_PWM_PIN,
+                                                pwm_pin_funcs);
+    jerry_set_object_native_handle(pin_obj, (uintptr_t)pin, zjs_pwm_free_pin);
+    zjs_obj_add_number_id(pin_obj, channel, ZJS_PROP_CHANNEL);
+    zjs_obj_add_string_id(pin_obj, polarity, ZJS_PROP_POLARITY);
+
+    zjs_pwm_set_period_cycles(pin_obj, pin, periodHW);
+    zjs_pwm_set_pulse_width_cycles(pin_obj, pin, pulseWidthHW);
 
     // TODO: When we implement close, we should release the reference on this
     return pin_obj;
@@ -226,6 +260,8 @@ jerry_value_t zjs_pwm_init()
     // effects: finds the PWM driver and registers the PWM JS object
     char devname[10];
 
+    cycles_per_ms = sys_clock_hw_cycles_per_sec / 1000.0;
+
     for (int i = 0; i < PWM_DEV_COUNT; i++) {
         snprintf(devname, 7, "PWM_%d", i);
         zjs_pwm_dev[i] = device_get_binding(devname);
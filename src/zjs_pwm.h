@@ -4,8 +4,10 @@
 #define __zjs_pwm_h__
 
 #include "jerry-api.h"
+#include "zjs_pins.h"
 
-extern void (*zjs_pwm_convert_pin)(uint32_t num, int *dev, int *pin);
+// pin map used to convert pin numbers in open(), or NULL for the default
+extern const zjs_pin_map_t *zjs_pwm_pins;
 
 jerry_value_t zjs_pwm_init();
 
@@ -0,0 +1,489 @@
+// Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_BUFFER
+#ifdef BUILD_MODULE_BUFFER
+#ifndef ZJS_LINUX_BUILD
+// Zephyr includes
+#include <zephyr.h>
+#endif
+
+#include <string.h>
+
+// JerryScript includes
+#include "jerry-api.h"
+
+// ZJS includes
+#include "zjs_buffer.h"
+#include "zjs_ringbuffer.h"
+#include "zjs_scope.h"
+#include "zjs_util.h"
+
+typedef enum sample_type {
+    TYPE_INT8,
+    TYPE_UINT8,
+    TYPE_INT16,
+    TYPE_UINT16,
+    TYPE_INT32,
+    TYPE_UINT32,
+    TYPE_FLOAT,
+    TYPE_DOUBLE
+} sample_type_t;
+
+static const struct {
+    const char *name;
+    uint8_t size;
+} sample_types[] = {
+    [TYPE_INT8] =   { "int8", 1 },
+    [TYPE_UINT8] =  { "uint8", 1 },
+    [TYPE_INT16] =  { "int16", 2 },
+    [TYPE_UINT16] = { "uint16", 2 },
+    [TYPE_INT32] =  { "int32", 4 },
+    [TYPE_UINT32] = { "uint32", 4 },
+    [TYPE_FLOAT] =  { "float", 4 },
+    [TYPE_DOUBLE] = { "double", 8 },
+};
+
+// Samples are kept in a Buffer of capacity * size bytes, oldest first from
+//   head, wrapping around at the end
+typedef struct ring_buffer {
+    jerry_value_t storage;          // Buffer object, owned by the ring
+    uint8_t *data;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+    uint8_t type;
+    uint8_t size;
+    double sum;                     // running sum of the samples held
+    double min;                     // smallest and largest samples held,
+    double max;                     //   while extremes_valid is set
+    bool extremes_valid;
+} ring_buffer_t;
+
+static ring_buffer_t *zjs_ringbuffer_find(const jerry_value_t obj)
+{
+    uintptr_t native;
+    if (!zjs_is_instance(obj, ZJS_CLASS_RING_BUFFER) ||
+        !jerry_get_object_native_handle(obj, &native))
+        return NULL;
+    return (ring_buffer_t *)native;
+}
+
+static void zjs_ringbuffer_free(uintptr_t handle)
+{
+    ring_buffer_t *ring = (ring_buffer_t *)handle;
+    jerry_release_value(ring->storage);
+    zjs_free(ring);
+}
+
+static double get_sample(ring_buffer_t *ring, uint32_t index)
+{
+    // requires: index is less than count, 0 for the oldest sample
+    //  effects: returns the sample at index
+    uint32_t slot = ring->head + index;
+    if (slot >= ring->capacity)
+        slot -= ring->capacity;
+    uint8_t *ptr = ring->data + slot * ring->size;
+
+    // memcpy since the slots are only aligned to the sample size by chance
+    union {
+        int8_t i8; uint8_t u8; int16_t i16; uint16_t u16;
+        int32_t i32; uint32_t u32; float f; double d;
+    } sample;
+    memcpy(&sample, ptr, ring->size);
+    switch (ring->type) {
+    case TYPE_INT8:     return sample.i8;
+    case TYPE_UINT8:    return sample.u8;
+    case TYPE_INT16:    return sample.i16;
+    case TYPE_UINT16:   return sample.u16;
+    case TYPE_INT32:    return sample.i32;
+    case TYPE_UINT32:   return sample.u32;
+    case TYPE_FLOAT:    return sample.f;
+    default:            return sample.d;
+    }
+}
+
+static double set_sample(ring_buffer_t *ring, uint32_t slot, double value)
+{
+    // effects: stores value in slot, converted to the sample type, and
+    //            returns the value as stored
+    union {
+        int8_t i8; uint8_t u8; int16_t i16; uint16_t u16;
+        int32_t i32; uint32_t u32; float f; double d;
+    } sample;
+
+    // integers wrap the way the Buffer write functions do
+    int64_t whole = 0;
+    if (value == value && value > -9.2e18 && value < 9.2e18)
+        whole = (int64_t)value;
+
+    switch (ring->type) {
+    case TYPE_INT8:     sample.i8 = whole;  value = sample.i8;  break;
+    case TYPE_UINT8:    sample.u8 = whole;  value = sample.u8;  break;
+    case TYPE_INT16:    sample.i16 = whole; value = sample.i16; break;
+    case TYPE_UINT16:   sample.u16 = whole; value = sample.u16; break;
+    case TYPE_INT32:    sample.i32 = whole; value = sample.i32; break;
+    case TYPE_UINT32:   sample.u32 = whole; value = sample.u32; break;
+    case TYPE_FLOAT:    sample.f = value;   value = sample.f;   break;
+    default:            sample.d = value;   break;
+    }
+    memcpy(ring->data + slot * ring->size, &sample, ring->size);
+    return value;
+}
+
+static void recompute_sum(ring_buffer_t *ring)
+{
+    ring->sum = 0;
+    for (uint32_t i = 0; i < ring->count; i++) {
+        ring->sum += get_sample(ring, i);
+    }
+}
+
+static void note_added(ring_buffer_t *ring, double value)
+{
+    // requires: called before count goes up
+    //  effects: folds value into the cached extremes
+    if (!ring->count) {
+        ring->min = ring->max = value;
+        ring->extremes_valid = true;
+    } else if (value != value) {
+        // NaN doesn't compare, leave it to a rescan
+        ring->extremes_valid = false;
+    } else if (ring->extremes_valid) {
+        if (value < ring->min)
+            ring->min = value;
+        if (value > ring->max)
+            ring->max = value;
+    }
+}
+
+static void note_removed(ring_buffer_t *ring, double value)
+{
+    // effects: invalidates the cached extremes if value was one of them
+    if (value == ring->min || value == ring->max || value != value)
+        ring->extremes_valid = false;
+}
+
+static void drop_oldest(ring_buffer_t *ring, uint32_t n)
+{
+    // requires: n is at most count
+    for (uint32_t i = 0; i < n; i++) {
+        double value = get_sample(ring, i);
+        ring->sum -= value;
+        note_removed(ring, value);
+    }
+    ring->head = (ring->head + n) % ring->capacity;
+    ring->count -= n;
+    if (!ring->count)
+        ring->sum = 0;
+}
+
+static jerry_value_t zjs_ringbuffer_push(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // requires: arg[0] - value to add
+    //  effects: adds the value as the newest sample, dropping the oldest one
+    //             if the ring is full
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring || argc < 1 || !jerry_value_is_number(argv[0]))
+        return zjs_error("zjs_ringbuffer_push: invalid argument");
+
+    if (ring->count == ring->capacity)
+        drop_oldest(ring, 1);
+
+    uint32_t slot = ring->head + ring->count;
+    if (slot >= ring->capacity)
+        slot -= ring->capacity;
+    double value = set_sample(ring, slot, jerry_get_number_value(argv[0]));
+    ring->sum += value;
+    note_added(ring, value);
+    ring->count++;
+
+    // floating point adds and subtracts drift, so start over once per lap
+    if (ring->type >= TYPE_FLOAT && slot == ring->capacity - 1)
+        recompute_sum(ring);
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t zjs_ringbuffer_shift(const jerry_value_t function_obj,
+                                          const jerry_value_t this,
+                                          const jerry_value_t argv[],
+                                          const jerry_length_t argc)
+{
+    //  effects: removes and returns the oldest sample, or undefined if empty
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_shift: ring buffer not found");
+    if (!ring->count)
+        return ZJS_UNDEFINED;
+
+    double value = get_sample(ring, 0);
+    drop_oldest(ring, 1);
+    return jerry_create_number(value);
+}
+
+static jerry_value_t zjs_ringbuffer_pop(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    //  effects: removes and returns the newest sample, or undefined if empty
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_pop: ring buffer not found");
+    if (!ring->count)
+        return ZJS_UNDEFINED;
+
+    double value = get_sample(ring, ring->count - 1);
+    note_removed(ring, value);
+    ring->count--;
+    ring->sum = ring->count ? ring->sum - value : 0;
+    return jerry_create_number(value);
+}
+
+static jerry_value_t zjs_ringbuffer_peek(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // requires: arg[0] - index, 0 for the oldest sample or negative to count
+    //             back from the newest (Default: 0)
+    //  effects: returns the sample at the index, or undefined if there isn't
+    //             one
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring || (argc >= 1 && !jerry_value_is_number(argv[0])))
+        return zjs_error("zjs_ringbuffer_peek: invalid argument");
+
+    double index = argc >= 1 ? jerry_get_number_value(argv[0]) : 0;
+    if (index < 0)
+        index += ring->count;
+    if (!(index >= 0 && index < ring->count))
+        return ZJS_UNDEFINED;
+    return jerry_create_number(get_sample(ring, (uint32_t)index));
+}
+
+static jerry_value_t zjs_ringbuffer_drain(const jerry_value_t function_obj,
+                                          const jerry_value_t this,
+                                          const jerry_value_t argv[],
+                                          const jerry_length_t argc)
+{
+    // requires: arg[0] - Buffer to copy samples into
+    //           arg[1] - offset in the Buffer (Default: 0)
+    //           arg[2] - most samples to move (Default: all)
+    //  effects: moves as many of the oldest samples as fit into the Buffer, in
+    //             the board's byte order, and returns how many were moved
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    zjs_buffer_t *buf = argc < 1 ? NULL : zjs_buffer_find(argv[0]);
+    if (!ring || !buf || (argc >= 2 && !jerry_value_is_number(argv[1])) ||
+        (argc >= 3 && !jerry_value_is_number(argv[2])))
+        return zjs_error("zjs_ringbuffer_drain: invalid argument");
+
+    // compare as doubles before casting, so negative and NaN values can't
+    //   turn into huge unsigned ones
+    double start = argc >= 2 ? jerry_get_number_value(argv[1]) : 0;
+    if (!(start >= 0 && start <= buf->bufsize))
+        return zjs_error("zjs_ringbuffer_drain: offset beyond buffer");
+    uint32_t offset = (uint32_t)start;
+
+    uint32_t n = (buf->bufsize - offset) / ring->size;
+    if (n > ring->count)
+        n = ring->count;
+    if (argc >= 3) {
+        double most = jerry_get_number_value(argv[2]);
+        if (!(most > 0))
+            n = 0;
+        else if (most < n)
+            n = (uint32_t)most;
+    }
+
+    // at most two copies, for before and after the wrap
+    uint32_t first = ring->capacity - ring->head;
+    if (first > n)
+        first = n;
+    memcpy(buf->buffer + offset, ring->data + ring->head * ring->size,
+           first * ring->size);
+    memcpy(buf->buffer + offset + first * ring->size, ring->data,
+           (n - first) * ring->size);
+
+    drop_oldest(ring, n);
+    return jerry_create_number(n);
+}
+
+static jerry_value_t zjs_ringbuffer_extreme(const jerry_value_t this,
+                                            bool max)
+{
+    // effects: returns the smallest or largest sample, or undefined if empty;
+    //            the extremes are cached as samples are pushed, so the ring
+    //            is only scanned again after one of them has left it
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_extreme: ring buffer not found");
+    if (!ring->count)
+        return ZJS_UNDEFINED;
+
+    if (!ring->extremes_valid) {
+        ring->min = ring->max = get_sample(ring, 0);
+        for (uint32_t i = 1; i < ring->count; i++) {
+            double value = get_sample(ring, i);
+            if (value < ring->min)
+                ring->min = value;
+            if (value > ring->max)
+                ring->max = value;
+        }
+        ring->extremes_valid = true;
+    }
+    return jerry_create_number(max ? ring->max : ring->min);
+}
+
+static jerry_value_t zjs_ringbuffer_min(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    return zjs_ringbuffer_extreme(this, false);
+}
+
+static jerry_value_t zjs_ringbuffer_max(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    return zjs_ringbuffer_extreme(this, true);
+}
+
+static jerry_value_t zjs_ringbuffer_sum(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    //  effects: returns the sum of the samples, kept as they're added
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_sum: ring buffer not found");
+    return jerry_create_number(ring->sum);
+}
+
+static jerry_value_t zjs_ringbuffer_average(const jerry_value_t function_obj,
+                                            const jerry_value_t this,
+                                            const jerry_value_t argv[],
+                                            const jerry_length_t argc)
+{
+    //  effects: returns the mean of the samples, or undefined if empty
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_average: ring buffer not found");
+    if (!ring->count)
+        return ZJS_UNDEFINED;
+    return jerry_create_number(ring->sum / ring->count);
+}
+
+static jerry_value_t zjs_ringbuffer_count(const jerry_value_t function_obj,
+                                          const jerry_value_t this,
+                                          const jerry_value_t argv[],
+                                          const jerry_length_t argc)
+{
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_count: ring buffer not found");
+    return jerry_create_number(ring->count);
+}
+
+static jerry_value_t zjs_ringbuffer_clear(const jerry_value_t function_obj,
+                                          const jerry_value_t this,
+                                          const jerry_value_t argv[],
+                                          const jerry_length_t argc)
+{
+    ring_buffer_t *ring = zjs_ringbuffer_find(this);
+    if (!ring)
+        return zjs_error("zjs_ringbuffer_clear: ring buffer not found");
+    ring->head = 0;
+    ring->count = 0;
+    ring->sum = 0;
+    return ZJS_UNDEFINED;
+}
+
+static const zjs_native_func_t ringbuffer_funcs[] = {
+    { zjs_ringbuffer_push, "push" },
+    { zjs_ringbuffer_shift, "shift" },
+    { zjs_ringbuffer_pop, "pop" },
+    { zjs_ringbuffer_peek, "peek" },
+    { zjs_ringbuffer_drain, "drain" },
+    { zjs_ringbuffer_min, "min" },
+    { zjs_ringbuffer_max, "max" },
+    { zjs_ringbuffer_sum, "sum" },
+    { zjs_ringbuffer_average, "average" },
+    { zjs_ringbuffer_count, "count" },
+    { zjs_ringbuffer_clear, "clear" },
+    { NULL, NULL }
+};
+
+// RingBuffer constructor
+static jerry_value_t zjs_ringbuffer(const jerry_value_t function_obj,
+                                    const jerry_value_t this,
+                                    const jerry_value_t argv[],
+                                    const jerry_length_t argc)
+{
+    // requires: arg[0] - capacity in samples
+    //           arg[1] - sample type: 'int8', 'uint8', 'int16', 'uint16',
+    //                    'int32', 'uint32', 'float' or 'double' (Default)
+    //  effects: creates a RingBuffer holding up to capacity samples, with all
+    //             of its memory allocated up front
+    if (argc < 1 || !jerry_value_is_number(argv[0]) ||
+        (argc >= 2 && !jerry_value_is_string(argv[1])))
+        return zjs_error("zjs_ringbuffer: invalid argument");
+
+    uint32_t capacity = (uint32_t)jerry_get_number_value(argv[0]);
+    if (capacity < 1)
+        return zjs_error("zjs_ringbuffer: capacity must be at least one");
+
+    sample_type_t type = TYPE_DOUBLE;
+    if (argc >= 2) {
+        ZJS_SCOPE(scope);
+        char *name = zjs_scope_string(&scope, argv[1], 15);
+        int count = sizeof(sample_types) / sizeof(sample_types[0]);
+        for (type = 0; type < count; type++) {
+            if (name && !strcmp(name, sample_types[type].name))
+                break;
+        }
+        if (type == count)
+            return zjs_error("zjs_ringbuffer: unknown sample type");
+    }
+
+    uint8_t size = sample_types[type].size;
+    if (capacity > UINT32_MAX / size)
+        return zjs_error("zjs_ringbuffer: capacity too large");
+
+    ring_buffer_t *ring = zjs_malloc(sizeof(ring_buffer_t));
+    jerry_value_t storage = zjs_buffer_create(capacity * size);
+    zjs_buffer_t *buf = zjs_buffer_find(storage);
+    if (!ring || !buf) {
+        zjs_free(ring);
+        jerry_release_value(storage);
+        return zjs_error("zjs_ringbuffer: unable to allocate ring buffer");
+    }
+
+    ring->storage = storage;
+    ring->data = buf->buffer;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+    ring->type = type;
+    ring->size = size;
+    ring->sum = 0;
+    ring->extremes_valid = false;
+
+    jerry_value_t ring_obj = zjs_create_instance(ZJS_CLASS_RING_BUFFER,
+                                                 ringbuffer_funcs);
+    zjs_obj_add_number(ring_obj, capacity, "capacity");
+    jerry_set_object_native_handle(ring_obj, (uintptr_t)ring,
+                                   zjs_ringbuffer_free);
+    return ring_obj;
+}
+
+void zjs_ringbuffer_init()
+{
+    jerry_value_t global_obj = jerry_get_global_object();
+    zjs_obj_add_function(global_obj, zjs_ringbuffer, "RingBuffer");
+    jerry_release_value(global_obj);
+}
+#endif // BUILD_MODULE_BUFFER
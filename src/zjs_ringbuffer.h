@@ -0,0 +1,11 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_ringbuffer_h__
+#define __zjs_ringbuffer_h__
+
+#include "jerry-api.h"
+
+// effects: adds the RingBuffer constructor to the global object
+void zjs_ringbuffer_init();
+
+#endif  // __zjs_ringbuffer_h__
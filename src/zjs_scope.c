@@ -0,0 +1,85 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include "zjs_common.h"
+#include "zjs_scope.h"
+#include "zjs_util.h"
+
+// allocations are rounded up to keep the next one aligned
+#define SCRATCH_ALIGN 8
+
+static uint8_t scratch[ZJS_SCRATCH_SIZE] __attribute__((aligned(SCRATCH_ALIGN)));
+static uint16_t scratch_used = 0;
+
+zjs_scope_t zjs_scope_begin(void)
+{
+    zjs_scope_t scope;
+    scope.value_count = 0;
+    scope.heap_count = 0;
+    scope.scratch_mark = scratch_used;
+    return scope;
+}
+
+void zjs_scope_release(zjs_scope_t *scope)
+{
+    for (int i = 0; i < scope->value_count; i++) {
+        jerry_release_value(scope->values[i]);
+    }
+    scope->value_count = 0;
+    for (int i = 0; i < scope->heap_count; i++) {
+        zjs_free(scope->heap[i]);
+    }
+    scope->heap_count = 0;
+    scratch_used = scope->scratch_mark;
+}
+
+jerry_value_t zjs_scope_add(zjs_scope_t *scope, jerry_value_t value)
+{
+    if (scope->value_count == ZJS_SCOPE_MAX_VALUES) {
+        // a fixed number of temporaries per call is a coding decision, so
+        //   make it loud rather than growing
+        PRINT("zjs_scope_add: scope is full, value will leak\n");
+        return value;
+    }
+    scope->values[scope->value_count++] = value;
+    return value;
+}
+
+void *zjs_scope_alloc(zjs_scope_t *scope, uint32_t size)
+{
+    uint32_t rounded = (size + SCRATCH_ALIGN - 1) & ~(SCRATCH_ALIGN - 1);
+    if (rounded <= ZJS_SCRATCH_SIZE - scratch_used) {
+        void *ptr = &scratch[scratch_used];
+        scratch_used += rounded;
+        return ptr;
+    }
+
+    if (scope->heap_count == ZJS_SCOPE_MAX_HEAP) {
+        DBG_PRINT("zjs_scope_alloc: no room for %lu bytes\n",
+                  (unsigned long)size);
+        return NULL;
+    }
+    void *ptr = zjs_malloc(size);
+    if (ptr) {
+        scope->heap[scope->heap_count++] = ptr;
+    }
+    return ptr;
+}
+
+char *zjs_scope_string(zjs_scope_t *scope, jerry_value_t value,
+                       uint32_t maxlen)
+{
+    if (!jerry_value_is_string(value)) {
+        return NULL;
+    }
+    jerry_size_t size = jerry_get_string_size(value);
+    if (size > maxlen) {
+        return NULL;
+    }
+    char *str = zjs_scope_alloc(scope, size + 1);
+    if (!str) {
+        return NULL;
+    }
+    int len = jerry_string_to_char_buffer(value, (jerry_char_t *)str, size);
+    str[len] = '\0';
+    return str;
+}
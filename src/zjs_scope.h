@@ -0,0 +1,71 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_scope_h__
+#define __zjs_scope_h__
+
+#include <stdint.h>
+
+#include "jerry-api.h"
+
+/*
+ * Scopes for native binding calls. A scope collects temporary jerry values
+ * and scratch memory used while handling one call, and gives them all back
+ * when the function returns, including on early error returns:
+ *
+ *     ZJS_SCOPE(scope);
+ *     char *name = zjs_scope_string(&scope, argv[0], 32);
+ *     if (!name)
+ *         return zjs_error("my_func: invalid name");
+ *     jerry_value_t value = zjs_scope_add(&scope, zjs_get_property(...));
+ *
+ * Scratch memory comes from a static arena that is reset in stack order as
+ * scopes end, so nested calls (native -> JS -> native) each get their own
+ * region. Requests that don't fit in the arena fall back to the heap.
+ *
+ * Don't return a value that was added to the scope; it will be released.
+ */
+
+#ifndef ZJS_SCRATCH_SIZE
+#ifdef ZJS_LINUX_BUILD
+#define ZJS_SCRATCH_SIZE 4096
+#else
+#define ZJS_SCRATCH_SIZE 512
+#endif
+#endif
+
+#define ZJS_SCOPE_MAX_VALUES 8
+#define ZJS_SCOPE_MAX_HEAP 2
+
+typedef struct zjs_scope {
+    jerry_value_t values[ZJS_SCOPE_MAX_VALUES];
+    void *heap[ZJS_SCOPE_MAX_HEAP];
+    uint16_t value_count;
+    uint16_t heap_count;
+    uint16_t scratch_mark;
+} zjs_scope_t;
+
+// declares a scope that is released automatically when it goes out of scope
+#define ZJS_SCOPE(name) \
+    zjs_scope_t name __attribute__((cleanup(zjs_scope_release))) = \
+        zjs_scope_begin()
+
+// effects: returns a new empty scope; prefer ZJS_SCOPE
+zjs_scope_t zjs_scope_begin(void);
+
+// effects: releases every value added to scope and frees its scratch memory
+void zjs_scope_release(zjs_scope_t *scope);
+
+// effects: hands value over to scope to release later, and returns it
+jerry_value_t zjs_scope_add(zjs_scope_t *scope, jerry_value_t value);
+
+// effects: returns size bytes of scratch memory that lives until scope is
+//            released, or NULL if out of memory
+void *zjs_scope_alloc(zjs_scope_t *scope, uint32_t size);
+
+// effects: if value is a string of at most maxlen bytes, returns a null
+//            terminated copy of it that lives until scope is released;
+//            otherwise returns NULL
+char *zjs_scope_string(zjs_scope_t *scope, jerry_value_t value,
+                       uint32_t maxlen);
+
+#endif  // __zjs_scope_h__
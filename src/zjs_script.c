@@ -1,65 +1,143 @@
 // Copyright (c) 2016, Intel Corporation.
 
+#include "zjs_script.h"
+
 #ifdef ZJS_LINUX_BUILD
 
+#include <fcntl.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#include "zjs_script.h"
+bool zjs_read_file(const char *name, const char **data, uint32_t *length)
+{
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        // there's nothing to map
+        close(fd);
+        *data = "";
+        *length = 0;
+        return true;
+    }
+
+    // the pages are only read in as the parser gets to them, and there's no
+    //   copy in the heap
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    *data = map;
+    *length = st.st_size;
+    return true;
+}
+
+void zjs_free_file(const char *data, uint32_t length)
+{
+    if (length) {
+        munmap((void *)data, length);
+    }
+}
+
+bool zjs_write_file(const char *name, const void *data, uint32_t length)
+{
+    FILE *f = fopen(name, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = !length || fwrite(data, length, 1, f) == 1;
+    if (fclose(f)) {
+        ok = false;
+    }
+    if (!ok) {
+        // don't leave a partial file behind
+        unlink(name);
+    }
+    return ok;
+}
 
 void zjs_read_script(char* name, const char** script, uint32_t* length)
 {
-    if (name) {
-        char* s;
-        uint32_t size;
-        FILE* f = fopen(name, "r");
-        if (!f) {
-            PRINT("zjs_read_script: Error opening file\n");
-            return;
-        }
-        if (fseek(f, 0L, SEEK_END)) {
-            PRINT("zjs_read_script: Error seeking to end of file\n");
-            fclose(f);
-            return;
-        }
-        size = ftell(f);
-        if (size == -1) {
-            PRINT("zjs_read_script: Error, ftell returned -1\n");
-            fclose(f);
-            return;
-        }
-        if (fseek(f, 0L, SEEK_SET)) {
-            PRINT("zjs_read_script: Error seeking to beginning of file\n");
-            fclose(f);
-            return;
-        }
-        s = (char*)zjs_malloc(size);
-        if (!s) {
-            PRINT("zjs_read_script: Error allocating %u bytes, fatal\n", size);
-            fclose(f);
-            return;
-        }
-        if (fread(s, size, 1, f) != 1) {
-            PRINT("zjs_read_script: Error reading script file\n");
-            fclose(f);
-            zjs_free(s);
-            return;
-        }
-
-        *script = s;
-        *length = size;
-        fclose(f);
-    }
-
-    return;
+    if (name && !zjs_read_file(name, script, length)) {
+        PRINT("zjs_read_script: Error reading script file %s\n", name);
+    }
 }
 
-void zjs_free_script(const char* script)
+void zjs_free_script(const char* script, uint32_t length)
 {
     if (script) {
-        zjs_free(script);
+        zjs_free_file(script, length);
+    }
+}
+
+#elif defined(CONFIG_FILE_SYSTEM)
+
+#include <string.h>
+#include <fs.h>
+
+bool zjs_read_file(const char *name, const char **data, uint32_t *length)
+{
+    // fs_open creates missing files, so check first
+    struct zfs_dirent entry;
+    if (fs_stat(name, &entry) || entry.type != DIR_ENTRY_FILE) {
+        return false;
+    }
+
+    uint32_t size = entry.size;
+    char *buf = zjs_malloc(size ? size : 1);
+    if (!buf) {
+        return false;
+    }
+    ZFILE file;
+    if (fs_open(&file, name)) {
+        zjs_free(buf);
+        return false;
+    }
+    ssize_t brw = fs_read(&file, buf, size);
+    fs_close(&file);
+    if (brw != size) {
+        zjs_free(buf);
+        return false;
+    }
+    *data = buf;
+    *length = size;
+    return true;
+}
+
+void zjs_free_file(const char *data, uint32_t length)
+{
+    zjs_free((void *)data);
+}
+
+bool zjs_write_file(const char *name, const void *data, uint32_t length)
+{
+    // fs_open doesn't truncate, so start from an empty file
+    struct zfs_dirent entry;
+    if (!fs_stat(name, &entry) && fs_unlink(name)) {
+        return false;
+    }
+    ZFILE file;
+    if (fs_open(&file, name)) {
+        return false;
+    }
+    bool ok = fs_write(&file, data, length) == length;
+    if (fs_close(&file)) {
+        ok = false;
+    }
+    if (!ok) {
+        fs_unlink(name);
     }
-    return;
+    return ok;
 }
 
 #endif
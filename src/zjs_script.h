@@ -8,8 +8,30 @@
 
 #include <stdlib.h>
 
+// require() can load JS files wherever there is a file system to load from
+#if defined(ZJS_LINUX_BUILD) || defined(CONFIG_FILE_SYSTEM)
+#define ZJS_FILE_MODULES
+#endif
+
+#ifdef ZJS_FILE_MODULES
+// effects: makes the contents of the file called name available in memory,
+//            mapped on Linux and read into the heap otherwise, and returns
+//            true; returns false without printing anything if the file can't
+//            be read; release the contents with zjs_free_file
+bool zjs_read_file(const char *name, const char **data, uint32_t *length);
+
+// effects: releases file contents from zjs_read_file
+void zjs_free_file(const char *data, uint32_t length);
+
+// effects: replaces the file called name with length bytes from data, and
+//            returns true on success
+bool zjs_write_file(const char *name, const void *data, uint32_t length);
+#endif
+
+#ifdef ZJS_LINUX_BUILD
 void zjs_read_script(char* name, const char** script, uint32_t* length);
 
-void zjs_free_script(const char* script);
+void zjs_free_script(const char* script, uint32_t length);
+#endif
 
 #endif /* ZJS_SCRIPT_H_ */
@@ -1,4 +1,5 @@
 // Copyright (c) 2016, Intel Corporation.
+#define ZJS_MEM_MODULE ZJS_MEM_TIMERS
 
 #ifndef ZJS_LINUX_BUILD
 // Zephyr includes
@@ -121,11 +122,11 @@ static jerry_value_t add_timer_helper(const jerry_value_t function_obj,
     uint32_t interval = (uint32_t)(jerry_get_number_value(argv[1]) / 1000 *
             CONFIG_SYS_CLOCK_TICKS_PER_SEC);
     jerry_value_t callback = argv[0];
-    jerry_value_t timer_obj = jerry_create_object();
-
     zjs_timer_t* handle = add_timer(interval, callback, this, repeat, argv, argc - 2);
-    if (handle->callback_id == -1)
+    if (!handle || handle->callback_id == -1)
         return zjs_error("native_set_interval_handler: timer alloc failed");
+
+    jerry_value_t timer_obj = jerry_create_object();
     jerry_set_object_native_handle(timer_obj, (uintptr_t)handle, NULL);
 
     return timer_obj;
@@ -202,6 +203,27 @@ void zjs_timers_process_events()
     }
 }
 
+uint32_t zjs_timers_next_ms()
+{
+    uint32_t next = UINT32_MAX;
+    for (zjs_timer_t *tm = zjs_timers; tm; tm = tm->next) {
+        if (!tm->completed) {
+            uint32_t ms = zjs_port_timer_ms_remaining(&tm->timer);
+            if (ms < next) {
+                next = ms;
+            }
+        }
+    }
+    return next;
+}
+
+void zjs_timers_cleanup()
+{
+    while (zjs_timers) {
+        delete_timer(zjs_timers->callback_id);
+    }
+}
+
 void zjs_timers_init()
 {
     jerry_value_t global_obj = jerry_get_global_object();
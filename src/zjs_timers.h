@@ -3,7 +3,16 @@
 #ifndef __zjs_timers_h__
 #define __zjs_timers_h__
 
+#include <stdint.h>
+
 void zjs_timers_process_events();
 void zjs_timers_init();
 
+// effects: returns milliseconds until the next timer expires, or UINT32_MAX
+//            if there are no timers
+uint32_t zjs_timers_next_ms();
+
+// effects: stops and frees every timer, releasing its callback and arguments
+void zjs_timers_cleanup();
+
 #endif  // __zjs_timers_h__
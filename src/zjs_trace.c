@@ -0,0 +1,326 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include "zjs_common.h"
+#include "zjs_trace.h"
+
+#ifdef ZJS_TRACE_MALLOC
+#include <string.h>
+
+#ifdef ZJS_LINUX_BUILD
+#include <signal.h>
+#include <stdlib.h>
+#include "zjs_linux_time.h"
+#else
+#include "zjs_zephyr_time.h"
+#endif
+
+#include "zjs_util.h"
+
+/*
+ * Memory cost (device sizes):
+ *
+ * ring:    16 bytes * TRACE_RING_SIZE   = 512 bytes
+ * sites:   32 bytes * TRACE_MAX_SITES   = 1024 bytes
+ * live:    12 bytes * TRACE_MAX_LIVE    = 768 bytes
+ *
+ * The live table only needs to cover what the allocator can hand out at once,
+ * which with the pool allocator is MAX_CONCURRENT_POINTERS in zjs_pool.c.
+ */
+#ifdef ZJS_LINUX_BUILD
+#define TRACE_RING_SIZE     1024
+#define TRACE_SITE_BITS     7
+#define TRACE_LIVE_BITS     12
+#else
+#define TRACE_RING_SIZE     32
+#define TRACE_SITE_BITS     5
+#define TRACE_LIVE_BITS     6
+#endif
+
+#define TRACE_MAX_SITES     (1 << TRACE_SITE_BITS)
+#define TRACE_MAX_LIVE      (1 << TRACE_LIVE_BITS)
+#define TRACE_NO_SITE       0xffff
+
+#define TRACE_OP_ALLOC      'a'
+#define TRACE_OP_FREE       'f'
+#define TRACE_OP_FAIL       'x'
+
+typedef struct trace_record {
+    void *ptr;
+    uint32_t time;
+    uint32_t size;
+    uint16_t site;
+    uint8_t op;
+} trace_record_t;
+
+typedef struct trace_site {
+    const char *func;
+    uint32_t line;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t fails;
+    uint32_t live_bytes;
+    uint32_t peak_bytes;
+    uint32_t total_bytes;
+} trace_site_t;
+
+typedef struct trace_live {
+    void *ptr;
+    uint32_t size;
+    uint16_t site;
+} trace_live_t;
+
+static trace_record_t ring[TRACE_RING_SIZE];
+static uint32_t ring_count = 0;
+static trace_site_t sites[TRACE_MAX_SITES];
+static trace_live_t live[TRACE_MAX_LIVE];
+
+// allocations we couldn't attribute because a table was full, and frees of
+//   pointers we never saw allocated
+static uint32_t sites_dropped = 0;
+static uint32_t live_dropped = 0;
+static uint32_t unknown_frees = 0;
+
+static uint32_t trace_hash(uint32_t key, int bits)
+{
+    // Fibonacci hashing; the high bits of the product are the well mixed ones
+    return (key * 2654435761u) >> (32 - bits);
+}
+
+static uint16_t find_site(const char *func, uint32_t line)
+{
+    // effects: returns the index of the site entry for func/line, creating
+    //            it if needed, or TRACE_NO_SITE if the table is full
+    uint32_t i = trace_hash((uint32_t)(uintptr_t)func ^ line, TRACE_SITE_BITS);
+    for (int n = 0; n < TRACE_MAX_SITES; n++) {
+        trace_site_t *site = &sites[i];
+        if (!site->func) {
+            site->func = func;
+            site->line = line;
+            return i;
+        }
+        if (site->func == func && site->line == line) {
+            return i;
+        }
+        i = (i + 1) & (TRACE_MAX_SITES - 1);
+    }
+    sites_dropped++;
+    return TRACE_NO_SITE;
+}
+
+static uint32_t find_live(void *ptr)
+{
+    // effects: returns the slot holding ptr, or the empty slot where it
+    //            would go, or TRACE_MAX_LIVE if the table is full
+    uint32_t i = trace_hash((uint32_t)(uintptr_t)ptr, TRACE_LIVE_BITS);
+    for (int n = 0; n < TRACE_MAX_LIVE; n++) {
+        if (!live[i].ptr || live[i].ptr == ptr) {
+            return i;
+        }
+        i = (i + 1) & (TRACE_MAX_LIVE - 1);
+    }
+    return TRACE_MAX_LIVE;
+}
+
+static void remove_live(uint32_t i)
+{
+    // effects: empties slot i, shifting back later entries in the same probe
+    //            run so lookups never need tombstones
+    uint32_t j = i;
+    while (1) {
+        j = (j + 1) & (TRACE_MAX_LIVE - 1);
+        if (!live[j].ptr) {
+            break;
+        }
+        uint32_t k = trace_hash((uint32_t)(uintptr_t)live[j].ptr,
+                                TRACE_LIVE_BITS);
+        // leave the entry alone if its home slot is cyclically in (i, j]
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        live[i] = live[j];
+        i = j;
+    }
+    live[i].ptr = NULL;
+}
+
+static void add_record(uint8_t op, void *ptr, uint32_t size, uint16_t site)
+{
+    trace_record_t *rec = &ring[ring_count++ % TRACE_RING_SIZE];
+    rec->ptr = ptr;
+    rec->time = zjs_port_get_us();
+    rec->size = size;
+    rec->site = site;
+    rec->op = op;
+}
+
+void *zjs_trace_malloc(uint32_t size, zjs_mem_module_t module,
+                       const char *func, uint32_t line)
+{
+    void *ptr = zjs_base_malloc(size, module);
+    uint16_t id = find_site(func, line);
+    if (!ptr) {
+        if (id != TRACE_NO_SITE) {
+            sites[id].fails++;
+        }
+        add_record(TRACE_OP_FAIL, NULL, size, id);
+        return NULL;
+    }
+
+    if (id != TRACE_NO_SITE) {
+        trace_site_t *site = &sites[id];
+        site->allocs++;
+        site->total_bytes += size;
+        site->live_bytes += size;
+        if (site->peak_bytes < site->live_bytes) {
+            site->peak_bytes = site->live_bytes;
+        }
+    }
+
+    uint32_t i = find_live(ptr);
+    if (i == TRACE_MAX_LIVE) {
+        live_dropped++;
+    } else {
+        live[i].ptr = ptr;
+        live[i].size = size;
+        live[i].site = id;
+    }
+
+    add_record(TRACE_OP_ALLOC, ptr, size, id);
+    return ptr;
+}
+
+void zjs_trace_free(void *ptr, const char *func, uint32_t line)
+{
+    if (ptr) {
+        uint32_t i = find_live(ptr);
+        if (i == TRACE_MAX_LIVE || !live[i].ptr) {
+            // attribute unknown frees to the caller so they can be found
+            unknown_frees++;
+            add_record(TRACE_OP_FREE, ptr, 0, find_site(func, line));
+        } else {
+            uint16_t id = live[i].site;
+            if (id != TRACE_NO_SITE) {
+                sites[id].frees++;
+                sites[id].live_bytes -= live[i].size;
+            }
+            add_record(TRACE_OP_FREE, ptr, live[i].size, id);
+            remove_live(i);
+        }
+    }
+    zjs_base_free(ptr);
+}
+
+#ifdef ZJS_LINUX_BUILD
+static FILE *trace_out;
+#define TRACE_OUT(...) fprintf(trace_out, __VA_ARGS__)
+#else
+#define TRACE_OUT PRINT
+#endif
+
+static void dump_snapshot(void)
+{
+    // effects: writes a snapshot in the line format read by
+    //            scripts/tracesummary:
+    //            T <time> <records> <sites_dropped> <live_dropped> <unknown_frees>
+    //            S <site> <func>:<line> <allocs> <frees> <fails> <live_bytes>
+    //              <peak_bytes> <total_bytes>
+    //            L <ptr> <size> <site>
+    //            R <time> <op> <ptr> <size> <site>
+    //            E
+    TRACE_OUT("T %lu %lu %lu %lu %lu\n", (unsigned long)zjs_port_get_us(),
+              (unsigned long)ring_count, (unsigned long)sites_dropped,
+              (unsigned long)live_dropped, (unsigned long)unknown_frees);
+
+    for (int i = 0; i < TRACE_MAX_SITES; i++) {
+        trace_site_t *site = &sites[i];
+        if (site->func) {
+            TRACE_OUT("S %d %s:%lu %lu %lu %lu %lu %lu %lu\n", i, site->func,
+                      (unsigned long)site->line, (unsigned long)site->allocs,
+                      (unsigned long)site->frees, (unsigned long)site->fails,
+                      (unsigned long)site->live_bytes,
+                      (unsigned long)site->peak_bytes,
+                      (unsigned long)site->total_bytes);
+        }
+    }
+
+    for (int i = 0; i < TRACE_MAX_LIVE; i++) {
+        if (live[i].ptr) {
+            TRACE_OUT("L %p %lu %u\n", live[i].ptr,
+                      (unsigned long)live[i].size, live[i].site);
+        }
+    }
+
+    // oldest record first
+    uint32_t count = ring_count < TRACE_RING_SIZE ? ring_count :
+                     TRACE_RING_SIZE;
+    for (uint32_t n = ring_count - count; n != ring_count; n++) {
+        trace_record_t *rec = &ring[n % TRACE_RING_SIZE];
+        TRACE_OUT("R %lu %c %p %lu %u\n", (unsigned long)rec->time, rec->op,
+                  rec->ptr, (unsigned long)rec->size, rec->site);
+    }
+    TRACE_OUT("E\n");
+}
+
+#ifdef ZJS_LINUX_BUILD
+static volatile sig_atomic_t snapshot_requested = 0;
+
+static void trace_signal_handler(int sig)
+{
+    snapshot_requested = 1;
+}
+#endif
+
+void zjs_trace_init(void)
+{
+#ifdef ZJS_LINUX_BUILD
+    signal(SIGUSR1, trace_signal_handler);
+#endif
+}
+
+void zjs_trace_dump(void)
+{
+#ifdef ZJS_LINUX_BUILD
+    trace_out = stdout;
+#endif
+    dump_snapshot();
+}
+
+void zjs_trace_service(void)
+{
+#ifdef ZJS_LINUX_BUILD
+    if (!snapshot_requested) {
+        return;
+    }
+    snapshot_requested = 0;
+
+    const char *filename = getenv("ZJS_TRACE_FILE");
+    if (!filename) {
+        filename = "zjs-trace.log";
+    }
+    trace_out = fopen(filename, "a");
+    if (!trace_out) {
+        PRINT("zjs_trace_service: unable to open %s\n", filename);
+        return;
+    }
+    dump_snapshot();
+    fclose(trace_out);
+    PRINT("zjs_trace_service: snapshot written to %s\n", filename);
+#endif
+}
+
+#else
+
+void zjs_trace_init(void)
+{
+}
+
+void zjs_trace_dump(void)
+{
+    PRINT("Allocation tracing not enabled, build with TRACE=on\n");
+}
+
+void zjs_trace_service(void)
+{
+}
+
+#endif  // ZJS_TRACE_MALLOC
@@ -0,0 +1,41 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#ifndef __zjs_trace_h__
+#define __zjs_trace_h__
+
+#include <stdint.h>
+
+#include "zjs_mem.h"
+
+/*
+ * Allocation tracing, enabled with ZJS_TRACE_MALLOC (make TRACE=on).
+ *
+ * Every zjs_malloc/zjs_free is recorded in a fixed size ring buffer and
+ * aggregated per call site (function + line). A snapshot of the per-site
+ * totals, the live allocations and the most recent records can be dumped at
+ * any time; scripts/tracesummary turns one or more snapshots into a report of
+ * leaks and hot allocation sites.
+ *
+ * The dump functions are always available so callers such as ashell don't
+ * need to know how the core was built; they just report that tracing is off.
+ */
+
+#ifdef ZJS_TRACE_MALLOC
+void *zjs_trace_malloc(uint32_t size, zjs_mem_module_t module,
+                       const char *func, uint32_t line);
+void zjs_trace_free(void *ptr, const char *func, uint32_t line);
+#endif
+
+// effects: sets up tracing; on Linux, installs a SIGUSR1 handler that
+//            requests a snapshot
+void zjs_trace_init(void);
+
+// effects: prints a heap snapshot to the console
+void zjs_trace_dump(void);
+
+// effects: writes a pending snapshot request out, call from the main loop;
+//            on Linux the snapshot is appended to $ZJS_TRACE_FILE, or
+//            zjs-trace.log if that isn't set
+void zjs_trace_service(void);
+
+#endif  // __zjs_trace_h__
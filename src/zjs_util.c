@@ -29,11 +29,13 @@ void zjs_queue_callback(struct zjs_callback *cb) {
     nano_fifo_put(&zjs_callbacks_fifo, cb);
 }
 
-void zjs_run_pending_callbacks()
+bool zjs_run_pending_callbacks()
 {
     // requires: call only from task context
-    //  effects: calls all the callbacks in the queue
+    //  effects: calls all the callbacks in the queue; returns true if there
+    //             were any
     struct zjs_callback *cb;
+    bool ran = false;
     while (1) {
         cb = nano_task_fifo_get(&zjs_callbacks_fifo, TICKS_NONE);
         if (!cb) {
@@ -46,10 +48,111 @@ void zjs_run_pending_callbacks()
         }
 
         cb->call_function(cb);
+        ran = true;
     }
+    return ran;
 }
 #endif // ZJS_LINUX_BUILD
 
+static const char *prop_strings[ZJS_PROP_COUNT] = {
+    [ZJS_PROP_ACTIVE_LOW] =     "activeLow",
+    [ZJS_PROP_BUS] =            "bus",
+    [ZJS_PROP_CALLBACK_ID] =    "callback_id",
+    [ZJS_PROP_CHANNEL] =        "channel",
+    [ZJS_PROP_DEVICE] =         "device",
+    [ZJS_PROP_EVENT] =          "\377event",
+    [ZJS_PROP_ONCHANGE] =       "onchange",
+    [ZJS_PROP_PIN] =            "pin",
+    [ZJS_PROP_POLARITY] =       "polarity",
+    [ZJS_PROP_PROMISE] =        "promise",
+    [ZJS_PROP_VALUE] =          "value",
+};
+
+static jerry_value_t prop_names[ZJS_PROP_COUNT];
+
+void zjs_init_prop_names()
+{
+    // names are created on first use, so a script only pays for the ones its
+    //   modules need
+    for (int i = 0; i < ZJS_PROP_COUNT; i++) {
+        prop_names[i] = 0;
+    }
+}
+
+void zjs_release_prop_names()
+{
+    for (int i = 0; i < ZJS_PROP_COUNT; i++) {
+        if (prop_names[i]) {
+            jerry_release_value(prop_names[i]);
+            prop_names[i] = 0;
+        }
+    }
+}
+
+jerry_value_t zjs_prop_name(zjs_prop_t id)
+{
+    // effects: returns the interned name for id; it stays owned by the table,
+    //            so don't release it
+    if (!prop_names[id]) {
+        prop_names[id] = jerry_create_string((const jerry_char_t *)
+                                             prop_strings[id]);
+    }
+    return prop_names[id];
+}
+
+// The helpers below come in two flavors: the plain ones take a C string and
+//   create a jerry string for it on each call, the *_id ones use an interned
+//   name. Both share these versions that take a jerry string name.
+
+static void add_value(jerry_value_t obj, jerry_value_t name,
+                      jerry_value_t value)
+{
+    // effects: sets the name field in obj to value, and releases value
+    jerry_set_property(obj, name, value);
+    jerry_release_value(value);
+}
+
+static bool get_boolean(jerry_value_t obj, jerry_value_t name, bool *flag)
+{
+    jerry_value_t value = jerry_get_property(obj, name);
+    bool rval = jerry_value_is_boolean(value);
+    if (rval) {
+        *flag = jerry_get_boolean_value(value);
+    }
+    jerry_release_value(value);
+    return rval;
+}
+
+static bool get_string(jerry_value_t obj, jerry_value_t name, char *buffer,
+                       int len)
+{
+    jerry_value_t value = jerry_get_property(obj, name);
+    bool rval = false;
+    if (jerry_value_is_string(value)) {
+        jerry_size_t jlen = jerry_get_string_size(value);
+        if (jlen < len) {
+            int wlen = jerry_string_to_char_buffer(value,
+                                                   (jerry_char_t *)buffer,
+                                                   jlen);
+            buffer[wlen] = '\0';
+            rval = true;
+        }
+    }
+    jerry_release_value(value);
+    return rval;
+}
+
+static bool get_double(jerry_value_t obj, jerry_value_t name, double *num)
+{
+    jerry_value_t value = jerry_get_property(obj, name);
+    bool rval = !jerry_value_has_error_flag(value);
+    if (rval) {
+        *num = jerry_get_number_value(value);
+    }
+    jerry_release_value(value);
+    return rval;
+}
+
 void zjs_set_property(const jerry_value_t obj, const char *str,
                       const jerry_value_t prop)
 {
@@ -58,6 +161,12 @@ void zjs_set_property(const jerry_value_t obj, const char *str,
     jerry_release_value(name);
 }
 
+void zjs_set_property_id(const jerry_value_t obj, zjs_prop_t id,
+                         const jerry_value_t prop)
+{
+    jerry_set_property(obj, zjs_prop_name(id), prop);
+}
+
 jerry_value_t zjs_get_property(const jerry_value_t obj, const char *name)
 {
     // requires: obj is an object, name is a property name string
@@ -69,15 +178,26 @@ jerry_value_t zjs_get_property(const jerry_value_t obj, const char *name)
     return rval;
 }
 
+jerry_value_t zjs_get_property_id(const jerry_value_t obj, zjs_prop_t id)
+{
+    // requires: obj is an object
+    //  effects: looks up the property id in obj, and returns it; the value
+    //             will be owned by the caller and must be released
+    return jerry_get_property(obj, zjs_prop_name(id));
+}
+
 void zjs_obj_add_boolean(jerry_value_t obj, bool flag, const char *name)
 {
     // requires: obj is an existing JS object
     //  effects: creates a new field in parent named name, set to value
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
-    jerry_value_t jbool = jerry_create_boolean(flag);
-    jerry_set_property(obj, jname, jbool);
+    add_value(obj, jname, jerry_create_boolean(flag));
     jerry_release_value(jname);
-    jerry_release_value(jbool);
+}
+
+void zjs_obj_add_boolean_id(jerry_value_t obj, bool flag, zjs_prop_t id)
+{
+    add_value(obj, zjs_prop_name(id), jerry_create_boolean(flag));
 }
 
 void zjs_obj_add_function(jerry_value_t obj, void *func, const char *name)
@@ -108,15 +228,25 @@ void zjs_obj_add_object(jerry_value_t parent, jerry_value_t child,
     jerry_release_value(jname);
 }
 
+void zjs_obj_add_object_id(jerry_value_t parent, jerry_value_t child,
+                           zjs_prop_t id)
+{
+    jerry_set_property(parent, zjs_prop_name(id), child);
+}
+
 void zjs_obj_add_string(jerry_value_t obj, const char *str, const char *name)
 {
     // requires: obj is an existing JS object
     //  effects: creates a new field in parent named name, set to sval
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
-    jerry_value_t jstr = jerry_create_string((const jerry_char_t *)str);
-    jerry_set_property(obj, jname, jstr);
+    add_value(obj, jname, jerry_create_string((const jerry_char_t *)str));
     jerry_release_value(jname);
-    jerry_release_value(jstr);
+}
+
+void zjs_obj_add_string_id(jerry_value_t obj, const char *str, zjs_prop_t id)
+{
+    add_value(obj, zjs_prop_name(id),
+              jerry_create_string((const jerry_char_t *)str));
 }
 
 void zjs_obj_add_number(jerry_value_t obj, double num, const char *name)
@@ -124,10 +254,13 @@ void zjs_obj_add_number(jerry_value_t obj, double num, const char *name)
     // requires: obj is an existing JS object
     //  effects: creates a new field in parent named name, set to nval
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
-    jerry_value_t jnum = jerry_create_number(num);
-    jerry_set_property(obj, jname, jnum);
+    add_value(obj, jname, jerry_create_number(num));
     jerry_release_value(jname);
-    jerry_release_value(jnum);
+}
+
+void zjs_obj_add_number_id(jerry_value_t obj, double num, zjs_prop_t id)
+{
+    add_value(obj, zjs_prop_name(id), jerry_create_number(num));
 }
 
 bool zjs_obj_get_boolean(jerry_value_t obj, const char *name, bool *flag)
@@ -135,16 +268,15 @@ bool zjs_obj_get_boolean(jerry_value_t obj, const char *name, bool *flag)
     // requires: obj is an existing JS object, value name should exist as
     //             boolean
     //  effects: retrieves field specified by name as a boolean
-    jerry_value_t value = zjs_get_property(obj, name);
-    if (jerry_value_has_error_flag(value))
-        return false;
-
-    if (!jerry_value_is_boolean(value))
-        return false;
+    jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+    bool rval = get_boolean(obj, jname, flag);
+    jerry_release_value(jname);
+    return rval;
+}
 
-    *flag = jerry_get_boolean_value(value);
-    jerry_release_value(value);
-    return true;
+bool zjs_obj_get_boolean_id(jerry_value_t obj, zjs_prop_t id, bool *flag)
+{
+    return get_boolean(obj, zjs_prop_name(id), flag);
 }
 
 bool zjs_obj_get_string(jerry_value_t obj, const char *name, char *buffer,
@@ -156,48 +288,50 @@ bool zjs_obj_get_string(jerry_value_t obj, const char *name, char *buffer,
     //             string, and can fit into the given buffer, copies it plus
     //             a null terminator into buffer and returns true; otherwise,
     //             returns false
-    jerry_value_t value = zjs_get_property(obj, name);
-    if (jerry_value_has_error_flag(value))
-        return false;
-
-    if (!jerry_value_is_string(value))
-        return false;
-
-    jerry_size_t jlen = jerry_get_string_size(value);
-    if (jlen >= len)
-        return false;
-
-    int wlen = jerry_string_to_char_buffer(value, (jerry_char_t *)buffer, jlen);
-    buffer[wlen] = '\0';
-
-    jerry_release_value(value);
+    jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+    bool rval = get_string(obj, jname, buffer, len);
+    jerry_release_value(jname);
+    return rval;
+}
 
-    return true;
+bool zjs_obj_get_string_id(jerry_value_t obj, zjs_prop_t id, char *buffer,
+                           int len)
+{
+    return get_string(obj, zjs_prop_name(id), buffer, len);
 }
 
 bool zjs_obj_get_double(jerry_value_t obj, const char *name, double *num)
 {
     // requires: obj is an existing JS object, value name should exist as number
-    //  effects: retrieves field specified by name as a uint32
-    jerry_value_t value = zjs_get_property(obj, name);
-    if (jerry_value_has_error_flag(value))
-        return false;
+    //  effects: retrieves field specified by name as a double
+    jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+    bool rval = get_double(obj, jname, num);
+    jerry_release_value(jname);
+    return rval;
+}
 
-    *num = jerry_get_number_value(value);
-    jerry_release_value(value);
-    return true;
+bool zjs_obj_get_double_id(jerry_value_t obj, zjs_prop_t id, double *num)
+{
+    return get_double(obj, zjs_prop_name(id), num);
 }
 
 bool zjs_obj_get_uint32(jerry_value_t obj, const char *name, uint32_t *num)
 {
     // requires: obj is an existing JS object, value name should exist as number
     //  effects: retrieves field specified by name as a uint32
-    jerry_value_t value = zjs_get_property(obj, name);
-    if (jerry_value_has_error_flag(value))
+    double value;
+    if (!zjs_obj_get_double(obj, name, &value))
         return false;
+    *num = (uint32_t)value;
+    return true;
+}
 
-    *num = (uint32_t)jerry_get_number_value(value);
-    jerry_release_value(value);
+bool zjs_obj_get_uint32_id(jerry_value_t obj, zjs_prop_t id, uint32_t *num)
+{
+    double value;
+    if (!get_double(obj, zjs_prop_name(id), &value))
+        return false;
+    *num = (uint32_t)value;
     return true;
 }
 
@@ -205,15 +339,81 @@ bool zjs_obj_get_int32(jerry_value_t obj, const char *name, int32_t *num)
 {
     // requires: obj is an existing JS object, value name should exist as number
     //  effects: retrieves field specified by name as a int32
-    jerry_value_t value = zjs_get_property(obj, name);
-    if (jerry_value_has_error_flag(value))
+    double value;
+    if (!zjs_obj_get_double(obj, name, &value))
         return false;
+    *num = (int32_t)value;
+    return true;
+}
 
-    *num = (int32_t)jerry_get_number_value(value);
-    jerry_release_value(value);
+bool zjs_obj_get_int32_id(jerry_value_t obj, zjs_prop_t id, int32_t *num)
+{
+    double value;
+    if (!get_double(obj, zjs_prop_name(id), &value))
+        return false;
+    *num = (int32_t)value;
     return true;
 }
 
+// prototypes are built lazily, so programs only pay for the kinds they use
+static jerry_value_t prototypes[ZJS_CLASS_COUNT];
+
+void zjs_init_prototypes()
+{
+    for (int i = 0; i < ZJS_CLASS_COUNT; i++) {
+        prototypes[i] = 0;
+    }
+}
+
+void zjs_release_prototypes()
+{
+    for (int i = 0; i < ZJS_CLASS_COUNT; i++) {
+        if (prototypes[i]) {
+            jerry_release_value(prototypes[i]);
+            prototypes[i] = 0;
+        }
+    }
+}
+
+static jerry_value_t get_prototype(zjs_class_t id,
+                                   const zjs_native_func_t *funcs)
+{
+    if (!prototypes[id]) {
+        jerry_value_t proto = jerry_create_object();
+        for (const zjs_native_func_t *f = funcs; f->function; f++) {
+            zjs_obj_add_function(proto, f->function, f->name);
+        }
+        prototypes[id] = proto;
+    }
+    return prototypes[id];
+}
+
+void zjs_set_class(jerry_value_t obj, zjs_class_t id,
+                   const zjs_native_func_t *funcs)
+{
+    jerry_value_t rval = jerry_set_prototype(obj, get_prototype(id, funcs));
+    jerry_release_value(rval);
+}
+
+jerry_value_t zjs_create_instance(zjs_class_t id,
+                                  const zjs_native_func_t *funcs)
+{
+    jerry_value_t obj = jerry_create_object();
+    zjs_set_class(obj, id, funcs);
+    return obj;
+}
+
+bool zjs_is_instance(jerry_value_t obj, zjs_class_t id)
+{
+    if (!prototypes[id] || !jerry_value_is_object(obj)) {
+        return false;
+    }
+    jerry_value_t proto = jerry_get_prototype(obj);
+    bool rval = proto == prototypes[id];
+    jerry_release_value(proto);
+    return rval;
+}
+
 bool zjs_hex_to_byte(char *buf, uint8_t *byte)
 {
     // requires: buf is a string with at least two hex chars
@@ -11,33 +11,47 @@
 
 #define ZJS_UNDEFINED jerry_create_undefined()
 
+// zjs_port_malloc/free are the raw allocator for the platform; everything
+//   else should use zjs_malloc/free so allocations can be traced
 #ifdef ZJS_LINUX_BUILD
 #include <stdlib.h>
-#define zjs_malloc(sz) malloc(sz)
-#define zjs_free(ptr) free((void *)ptr)
-#else
-#ifndef ZJS_POOL_CONFIG
-#ifdef ZJS_TRACE_MALLOC
-#include <zephyr.h>
-#define zjs_malloc(sz) ({void *zjs_ptr = task_malloc(sz); PRINT("%s:%d: allocating %lu bytes (%p)\n", __func__, __LINE__, (uint32_t)sz, zjs_ptr); zjs_ptr;})
-#define zjs_free(ptr) (PRINT("%s:%d: freeing %p\n", __func__, __LINE__, ptr), task_free(ptr))
+#define zjs_port_malloc(sz) malloc(sz)
+#define zjs_port_free(ptr) free((void *)ptr)
 #else
 #include <zephyr.h>
-#define zjs_malloc(sz) task_malloc(sz)
-#define zjs_free(ptr) task_free(ptr)
-#endif  // ZJS_TRACE_MALLOC
+#ifdef ZJS_POOL_CONFIG
+#define zjs_port_malloc(sz) pool_malloc(sz)
+#define zjs_port_free(ptr) pool_free(ptr)
+#define zjs_port_low_water() pool_low_water()
 #else
+#define zjs_port_malloc(sz) task_malloc(sz)
+#define zjs_port_free(ptr) task_free(ptr)
+#endif  // ZJS_POOL_CONFIG
+#endif  // ZJS_LINUX_BUILD
+
+// zjs_port_low_water is true when the allocator is close to running out
+#ifndef zjs_port_low_water
+#define zjs_port_low_water() false
+#endif
+
+// zjs_base_malloc/free add memory pressure handling and, when enabled,
+//   per-module accounting on top of that
+#include "zjs_mem.h"
+#ifndef ZJS_MEM_MODULE
+#define ZJS_MEM_MODULE ZJS_MEM_CORE
+#endif
+
+#define zjs_base_malloc(sz, mod) zjs_mem_malloc(sz, mod)
+#define zjs_base_free(ptr) zjs_mem_free((void *)(ptr))
+
 #ifdef ZJS_TRACE_MALLOC
-#include <zephyr.h>
-#define zjs_malloc(sz) ({void *zjs_ptr = pool_malloc(sz); PRINT("%s:%d: allocating %lu bytes (%p)\n", __func__, __LINE__, (uint32_t)sz, zjs_ptr); zjs_ptr;})
-#define zjs_free(ptr) (PRINT("%s:%d: freeing %p\n", __func__, __LINE__, ptr), pool_free(ptr))
+#include "zjs_trace.h"
+#define zjs_malloc(sz) zjs_trace_malloc(sz, ZJS_MEM_MODULE, __func__, __LINE__)
+#define zjs_free(ptr) zjs_trace_free((void *)(ptr), __func__, __LINE__)
 #else
-#include <zephyr.h>
-#define zjs_malloc(sz) pool_malloc(sz)
-#define zjs_free(ptr) pool_free(ptr)
+#define zjs_malloc(sz) zjs_base_malloc(sz, ZJS_MEM_MODULE)
+#define zjs_free(ptr) zjs_base_free(ptr)
 #endif  // ZJS_TRACE_MALLOC
-#endif  // ZJS_POOL_CONFIG
-#endif  // ZJS_LINUX_BUILD
 
 struct zjs_callback;
 
@@ -55,7 +69,7 @@ struct zjs_callback {
 //   this to zjs_common
 void zjs_queue_init();
 void zjs_queue_callback(struct zjs_callback *cb);
-void zjs_run_pending_callbacks();
+bool zjs_run_pending_callbacks();
 
 void zjs_set_property(const jerry_value_t obj, const char *str,
                       const jerry_value_t prop);
@@ -75,6 +89,84 @@ bool zjs_obj_get_double(jerry_value_t obj, const char *name, double *num);
 bool zjs_obj_get_uint32(jerry_value_t obj, const char *name, uint32_t *num);
 bool zjs_obj_get_int32(jerry_value_t obj, const char *name, int32_t *num);
 
+// Property names used on hot paths, created as jerry strings once at init
+//   so lookups don't create and release a new string every time; use these
+//   with the *_id variants of the helpers above
+typedef enum zjs_prop {
+    ZJS_PROP_ACTIVE_LOW,
+    ZJS_PROP_BUS,
+    ZJS_PROP_CALLBACK_ID,
+    ZJS_PROP_CHANNEL,
+    ZJS_PROP_DEVICE,
+    ZJS_PROP_EVENT,         // hidden, holds an object's event emitter
+    ZJS_PROP_ONCHANGE,
+    ZJS_PROP_PIN,
+    ZJS_PROP_POLARITY,
+    ZJS_PROP_PROMISE,
+    ZJS_PROP_VALUE,
+    ZJS_PROP_COUNT
+} zjs_prop_t;
+
+// effects: resets the interned property names, which are then created on
+//            first use; call after every jerry_init(), and release them
+//            before jerry_cleanup()
+void zjs_init_prop_names();
+void zjs_release_prop_names();
+jerry_value_t zjs_prop_name(zjs_prop_t id);
+
+void zjs_set_property_id(const jerry_value_t obj, zjs_prop_t id,
+                         const jerry_value_t prop);
+jerry_value_t zjs_get_property_id(const jerry_value_t obj, zjs_prop_t id);
+
+void zjs_obj_add_boolean_id(jerry_value_t obj, bool flag, zjs_prop_t id);
+void zjs_obj_add_object_id(jerry_value_t parent, jerry_value_t child,
+                           zjs_prop_t id);
+void zjs_obj_add_string_id(jerry_value_t obj, const char *str, zjs_prop_t id);
+void zjs_obj_add_number_id(jerry_value_t obj, double num, zjs_prop_t id);
+
+bool zjs_obj_get_boolean_id(jerry_value_t obj, zjs_prop_t id, bool *flag);
+bool zjs_obj_get_string_id(jerry_value_t obj, zjs_prop_t id, char *buffer,
+                           int len);
+bool zjs_obj_get_double_id(jerry_value_t obj, zjs_prop_t id, double *num);
+bool zjs_obj_get_uint32_id(jerry_value_t obj, zjs_prop_t id, uint32_t *num);
+bool zjs_obj_get_int32_id(jerry_value_t obj, zjs_prop_t id, int32_t *num);
+
+// Native object kinds whose methods live on a shared prototype instead of
+//   being added to every instance
+typedef enum zjs_class {
+    ZJS_CLASS_AIO_PIN,
+    ZJS_CLASS_BUFFER,
+    ZJS_CLASS_EVENT_EMITTER,
+    ZJS_CLASS_GPIO_PIN,
+    ZJS_CLASS_I2C,
+    ZJS_CLASS_PWM_PIN,
+    ZJS_CLASS_RING_BUFFER,
+    ZJS_CLASS_COUNT
+} zjs_class_t;
+
+typedef struct zjs_native_func {
+    void *function;
+    const char *name;
+} zjs_native_func_t;
+
+// effects: forgets any prototypes built so far; call after every jerry_init(),
+//            and release them before jerry_cleanup()
+void zjs_init_prototypes();
+void zjs_release_prototypes();
+
+// requires: funcs is a static table ending with a NULL entry, the same table
+//             every time for a given id
+//  effects: returns a new object whose prototype holds funcs, building the
+//             prototype on first use; obj must be released by the caller
+jerry_value_t zjs_create_instance(zjs_class_t id,
+                                  const zjs_native_func_t *funcs);
+// effects: like zjs_create_instance, but links an existing plain object
+void zjs_set_class(jerry_value_t obj, zjs_class_t id,
+                   const zjs_native_func_t *funcs);
+// effects: returns true if obj was made with zjs_create_instance for id, so
+//            its native handle can be trusted to be that kind's struct
+bool zjs_is_instance(jerry_value_t obj, zjs_class_t id);
+
 bool zjs_hex_to_byte(char *buf, uint8_t *byte);
 
 void zjs_default_convert_pin(uint32_t orig, int *dev, int *pin);
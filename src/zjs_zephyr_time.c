@@ -0,0 +1,27 @@
+// Copyright (c) 2016, Intel Corporation.
+
+#include "zjs_zephyr_time.h"
+
+uint32_t zjs_port_timer_ms_remaining(zjs_port_timer_t *timer)
+{
+    int32_t ticks = nano_timer_ticks_remain(timer);
+    if (ticks <= 0) {
+        return 0;
+    }
+    return (uint32_t)ticks * 1000 / CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+}
+
+static uint32_t last_cycles = 0;
+static uint64_t total_cycles = 0;
+
+uint32_t zjs_port_get_us(void)
+{
+    // effects: extends the 32-bit hardware cycle counter to 64 bits and
+    //            returns it scaled to microseconds; the counter wraps about
+    //            every two minutes at 32MHz, so this must be called more
+    //            often than that to stay accurate
+    uint32_t now = sys_cycle_get_32();
+    total_cycles += now - last_cycles;
+    last_cycles = now;
+    return (uint32_t)(total_cycles * 1000000 / sys_clock_hw_cycles_per_sec);
+}
@@ -13,4 +13,12 @@
 #define ZJS_TICKS_NONE          TICKS_NONE
 #define zjs_sleep               task_sleep
 
+uint32_t zjs_port_timer_ms_remaining(zjs_port_timer_t *timer);
+
+/*
+ * Free-running microsecond counter, for measuring intervals by unsigned
+ * subtraction. Only call from task context.
+ */
+uint32_t zjs_port_get_us(void);
+
 #endif /* ZJS_ZEPHYR_TIME_H_ */
@@ -0,0 +1,10 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Module for test-require.js, with state that should be shared by everyone
+// who requires it
+
+var count = 0;
+
+exports.next = function() {
+    return ++count;
+};
@@ -0,0 +1,8 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Module for test-require.js that requires a module relative to its own
+// directory, and replaces its exports object
+
+module.exports = {
+    counter: require('../counter')
+};
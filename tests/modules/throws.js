@@ -0,0 +1,6 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Module for test-require.js that fails while loading
+
+exports.loaded = true;
+throw new Error("throws.js failed to load");
@@ -87,11 +87,123 @@ for(var i = 0; i < hexs.length; i++) {
 assert(buff.toString('hex') === expected,
        "The value of toString('hex') expected:" + expected + " got:" + buff.toString('hex'));
 
-var test_toString_error = "Error thrown when 'hex' is not given to toString()";
+var test_toString_error = "Error thrown when an unsupported encoding is given to toString()";
 try {
     // unsupported encoding
-    buff.toString("utf8");
+    buff.toString("ucs2");
     assert(false, test_toString_error);
 } catch(e) {
     assert(true, test_toString_error);
 }
+
+// Encodings: hex, base64, utf8 and ascii
+buff = new Buffer("foob");
+assert(buff.toString('base64') === "Zm9vYg==",
+       "The value of toString('base64') expected: Zm9vYg== got:" + buff.toString('base64'));
+assert(buff.toString('utf8') === "foob" && buff.toString('ascii') === "foob",
+       "toString('utf8') and toString('ascii') return the text");
+assert(buff.toString('hex', 1, 3) === "6f6f", "toString() converts a range");
+buff = new Buffer("Zm9vYmFy", "base64");
+assert(buff.length === 6 && buff.toString('utf8') === "foobar",
+       "Buffer(string, 'base64') decodes the string");
+buff = new Buffer("c3a9", "hex");
+assert(buff.length === 2 && buff.toString('utf8') === "\u00e9",
+       "Buffer(string, 'hex') decodes the string");
+buff = new Buffer(4);
+var written = buff.write("0102zz", 1, "hex");
+assert(written === 2 && buff.readUInt16BE(1) === 0x0102,
+       "write() decodes hex up to the first invalid pair");
+written = buff.write("\u00e9\u00e9\u00e9", "utf8");
+assert(written === 4, "write() doesn't split a character at the end of the Buffer");
+written = buff.write("abcdefgh", 1, 4294967295);
+assert(written === 3 && buff.toString('ascii', 1) === "abc",
+       "write() stops at the end of the Buffer for an oversized length");
+var test_write_error = "Error thrown for a negative write() length";
+try {
+    buff.write("abcdefgh", 1, -1);
+    assert(false, test_write_error);
+} catch(e) {
+    assert(true, test_write_error);
+}
+
+// Functions: pack(string format, array values, unsigned long offset)
+//            array unpack(string format, unsigned long offset)
+buff = new Buffer(16);
+var end = buff.pack(">Hhbxf", [513, -2, -1, 1.5], 1);
+assert(end === 11, "pack() returns the offset after the record, expected: 11 got: " + end);
+assert(buff.readUInt16BE(1) === 513 && buff.readUInt16BE(3) === 0xfffe,
+       "pack() writes big endian fields");
+var fields = buff.unpack(">Hhbxf", 1);
+assert(fields.length === 4 && fields[0] === 513 && fields[1] === -2 &&
+       fields[2] === -1 && fields[3] === 1.5,
+       "unpack() returns the values that were packed");
+fields = buff.unpack("<2B", 1);
+assert(fields[0] === 2 && fields[1] === 1, "unpack() reads repeated fields");
+
+var test_unpack_error = "Error thrown when unpack() reads beyond the Buffer";
+try {
+    buff.unpack("<d", 12);
+    assert(false, test_unpack_error);
+} catch(e) {
+    assert(true, test_unpack_error);
+}
+
+var test_format_error = "Error thrown for an invalid pack format";
+try {
+    buff.pack("<q", [1]);
+    assert(false, test_format_error);
+} catch(e) {
+    assert(true, test_format_error);
+}
+
+// Function: Buffer slice(long start, long end)
+buff = new Buffer(8);
+for (var i = 0; i < 8; i++) {
+    buff.writeUInt8(i, i);
+}
+var view = buff.slice(2, 6);
+assert(view.length === 4, "The length of slice(2, 6) expected: 4 got: " + view.length);
+assert(view.readUInt8(0) === 2, "slice(2, 6) starts at offset 2");
+view.writeUInt8(42, 1);
+assert(buff.readUInt8(3) === 42, "A write to a slice is seen in the original Buffer");
+view = buff.slice(-2);
+assert(view.length === 2 && view.readUInt8(0) === 6,
+       "slice(-2) covers the last two bytes");
+view = buff.slice(5, 3);
+assert(view.length === 0, "slice() with end before start is empty");
+view = buff.slice(NaN);
+assert(view.length === buff.length, "slice(NaN) starts at offset 0");
+view = buff.slice(0, NaN);
+assert(view.length === 0, "slice(0, NaN) is empty");
+
+// Functions: copy, fill, compare, equals, indexOf, Buffer.concat
+buff = new Buffer(6);
+buff.fill(0);
+assert(buff.readUInt32BE(0) === 0 && buff.readUInt16BE(4) === 0,
+       "fill(0) clears the Buffer");
+buff.fill("ab", 1, 5);
+assert(buff.toString('hex') === "006162616200", "fill() repeats a string pattern");
+assert(buff.indexOf("ba") === 2, "indexOf() finds a string");
+assert(buff.indexOf(0x62, 3) === 4, "indexOf() finds a byte after an offset");
+assert(buff.indexOf("zz") === -1, "indexOf() returns -1 when not found");
+
+var target = new Buffer(4);
+target.fill(0xff);
+var copied = buff.copy(target, 1, 1);
+assert(copied === 3 && target.toString('hex') === "ff616261",
+       "copy() stops at the end of the target");
+
+var other = new Buffer(6);
+buff.copy(other);
+assert(buff.equals(other) && buff.compare(other) === 0,
+       "A copy equals the original");
+other.writeUInt8(0x63, 1);
+assert(!buff.equals(other) && buff.compare(other) === -1,
+       "compare() orders Buffers by their bytes");
+
+var joined = Buffer.concat([target, buff.slice(1, 3)]);
+assert(joined.length === 6 && joined.toString('hex') === "ff6162616162",
+       "Buffer.concat() joins Buffers in order");
+joined = Buffer.concat([target], 6);
+assert(joined.toString('hex') === "ff6162610000",
+       "Buffer.concat() zero pads to totalLength");
@@ -0,0 +1,52 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Memory accounting testing, needs a MEM_STATS=on build
+
+function assert(actual, description) {
+    print((actual === true ? "\033[1m\033[32mPASS\033[0m":"\033[1m\033[31mFAIL\033[0m") +
+           " - " + description);
+}
+
+var memory = require('memory');
+
+var stats = memory.stats();
+assert(typeof stats.core === "object" && typeof stats.timers === "object",
+       "stats() has an entry per module");
+assert(stats.core.used <= stats.core.peak, "used never exceeds peak");
+memory.resetPeaks();
+var sum = 0;
+stats = memory.stats();
+for (var name in stats) {
+    sum += stats[name].peak;
+}
+assert(memory.peak() <= sum, "peak() is at most the sum of module peaks");
+
+var before = memory.stats().timers.used;
+var allocs = memory.stats().timers.allocs;
+var blocks = memory.stats().timers.blocks;
+var timer = setTimeout(function() {}, 1000);
+assert(memory.stats().timers.used > before, "setTimeout charged to timers");
+assert(memory.stats().timers.allocs > allocs, "setTimeout counts allocations");
+clearTimeout(timer);
+assert(memory.stats().timers.used === before, "clearTimeout frees timer memory");
+assert(memory.stats().timers.blocks === blocks,
+       "clearTimeout leaves no live blocks");
+
+memory.setQuota("timers", before + 1);
+var denied = memory.stats().timers.denied;
+try {
+    setTimeout(function() {}, 1000);
+    assert(false, "setTimeout fails when over quota");
+} catch (err) {
+    assert(memory.stats().timers.denied > denied,
+           "setTimeout fails when over quota");
+}
+memory.setQuota("timers", 0);
+assert(memory.stats().timers.quota === 0, "quota can be removed");
+
+try {
+    memory.setQuota("nosuchmodule", 100);
+    assert(false, "setQuota rejects unknown module");
+} catch (err) {
+    assert(true, "setQuota rejects unknown module");
+}
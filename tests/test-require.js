@@ -0,0 +1,43 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// Testing require() of JS files, run with the tests directory as the script's
+// directory, e.g. ./jslinux tests/test-require.js
+
+function assert(actual, description) {
+    print((actual === true ? "\033[1m\033[32mPASS\033[0m":"\033[1m\033[31mFAIL\033[0m") +
+           " - " + description);
+}
+
+var counter = require('./modules/counter');
+assert(typeof counter.next === "function", "require loads a JS file");
+assert(counter.next() === 1, "module code runs");
+
+var again = require('./modules/counter.js');
+assert(again === counter, "second require returns the same exports");
+assert(again.next() === 2, "module state is kept between requires");
+
+var relative = require('./modules/lib/relative.js');
+assert(relative.counter === counter,
+       "module requires resolve relative to the module");
+assert(typeof next === "undefined" && typeof count === "undefined",
+       "module variables don't leak into the global scope");
+
+try {
+    require('./modules/missing');
+    assert(false, "missing module throws an error");
+} catch (err) {
+    assert(true, "missing module throws an error");
+}
+
+var failures = 0;
+for (var i = 0; i < 2; i++) {
+    try {
+        require('./modules/throws');
+    } catch (err) {
+        failures++;
+    }
+}
+assert(failures === 2, "module that throws isn't cached");
+
+assert(require('events') === require('events'),
+       "built in modules are still found");
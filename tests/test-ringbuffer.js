@@ -0,0 +1,74 @@
+// Copyright (c) 2016, Intel Corporation.
+
+// RingBuffer Testing
+
+function assert(actual, description) {
+    print((actual === true ? "\033[1m\033[32mPASS\033[0m":"\033[1m\033[31mFAIL\033[0m") +
+           " - " + description);
+}
+
+// Attribute: readonly unsigned long capacity
+var ring = new RingBuffer(4, 'int16');
+assert(ring.capacity === 4, "The capacity of RingBuffer(4) expected: 4 got: " + ring.capacity);
+assert(ring.count() === 0 && ring.shift() === undefined,
+       "A new RingBuffer is empty");
+
+// Function: push, shift, pop, peek
+ring.push(1);
+ring.push(-2);
+ring.push(3);
+assert(ring.count() === 3 && ring.peek(0) === 1 && ring.peek(-1) === 3,
+       "peek() counts from the oldest, or from the newest if negative");
+ring.push(4);
+ring.push(5);
+assert(ring.count() === 4 && ring.peek() === -2,
+       "push() drops the oldest sample when full");
+assert(ring.shift() === -2 && ring.pop() === 5 && ring.count() === 2,
+       "shift() removes the oldest sample and pop() the newest");
+ring.push(70000);
+assert(ring.peek(-1) === 4464, "Samples wrap to the sample type");
+
+// Functions: min, max, sum, average
+ring.clear();
+var values = [5, -3, 8, 2, 9, -7];
+for (var i = 0; i < values.length; i++) {
+    ring.push(values[i]);
+}
+assert(ring.min() === -7 && ring.max() === 9,
+       "min() and max() cover the samples held, expected: -7 9 got: " +
+       ring.min() + " " + ring.max());
+assert(ring.sum() === 12 && ring.average() === 3,
+       "sum() and average() cover the samples held, expected: 12 3 got: " +
+       ring.sum() + " " + ring.average());
+ring.push(1);
+ring.push(0);
+ring.push(3);
+assert(ring.min() === -7 && ring.max() === 3,
+       "min() and max() follow samples as they drop out, expected: -7 3 got: " +
+       ring.min() + " " + ring.max());
+ring.shift();
+assert(ring.min() === 0, "min() follows samples as they are shifted out");
+ring.clear();
+for (var i = 2; i < values.length; i++) {
+    ring.push(values[i]);
+}
+
+// Function: drain
+var buff = new Buffer(6);
+var moved = ring.drain(buff);
+assert(moved === 3 && ring.count() === 1,
+       "drain() moves as many samples as fit, expected: 3 got: " + moved);
+var fields = buff.unpack("<3h");
+assert(fields[0] === 8 && fields[1] === 2 && fields[2] === 9,
+       "drain() moves the oldest samples first");
+assert(ring.sum() === -7, "drain() updates the sum");
+assert(ring.drain(buff, 0, -1) === 0 && ring.count() === 1,
+       "drain() moves nothing for a negative count");
+
+var test_type_error = "Error thrown for an unknown sample type";
+try {
+    new RingBuffer(4, 'int64');
+    assert(false, test_type_error);
+} catch(e) {
+    assert(true, test_type_error);
+}